@@ -7,6 +7,29 @@
 //#define HAS_DEVICE
 
 #define DEBUG
+
+/* Cache decoded instructions by eip, see cpu/decode/decode-cache.c */
+#define USE_DECODE_CACHE
+
+/* Run whole basic blocks when nothing needs to be checked between
+ * instructions, requires USE_DECODE_CACHE, see cpu/block.c */
+#define USE_BLOCK_CACHE
+
+/* Compute EFLAGS only when read, see cpu/eflags.c. Every helper reading
+ * CF, PF, ZF, SF or OF must go through eflags_sync() or eflags_test_cc()
+ * first. The jcc, cmp and test helpers in opcode_table[] still read
+ * `cpu.eflags' directly, so this is off until they do. */
+//#define LAZY_EFLAGS
+
+/* Build the computed-goto loop in cpu/exec/exec-goto.c. `nemu -g' then
+ * interprets with it instead of the basic-block cache, unless the JIT
+ * is enabled */
+#define USE_GOTO_CORE
+
+/* Fetch instructions through a host pointer to the current code page,
+ * see memory/memory.c */
+#define USE_FETCH_WINDOW
+
 #define LOG_FILE
 
 #include "debug.h"
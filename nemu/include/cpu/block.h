@@ -0,0 +1,51 @@
+#ifndef __BLOCK_H__
+#define __BLOCK_H__
+
+#include "cpu/decode/decode-cache.h"
+
+/* Basic-block cache. Guest code is split into blocks ending at control
+ * transfer instructions, and each block is kept as an array of decoded
+ * instructions which is run in a tight loop without fetch or decode.
+ */
+
+#define BLOCK_WIDTH 10
+#define NR_BLOCK (1 << BLOCK_WIDTH)
+#define MAX_BLOCK_INSTR 32
+
+typedef struct {
+	/* NULL if the instruction is not a single decode-execute pair,
+	 * it is then run through exec() every time */
+	void (*execute) (Operands *);
+	/* the specialized handler, see decode-cache.h */
+	int (*helper) (swaddr_t, Operands *);
+	int len;
+	/* non-zero if this and the next instruction run as one, see fusion.c */
+	int fusion;
+	Operands ops;
+} BInstr;
+
+/* Translated code returns the number of guest instructions executed. */
+typedef uint32_t (*jit_code_t) (void);
+
+typedef struct {
+	swaddr_t eip;
+	uint32_t gen;
+	/* the physical pages of the first and the last byte, and their
+	 * generations in `code_gen' when the block was built */
+	uint32_t page[2], page_gen[2];
+	int nr_instr;
+	uint32_t exec_count;
+	jit_code_t jit_code;
+	BInstr instr[MAX_BLOCK_INSTR];
+} Block;
+
+uint32_t block_exec(uint32_t);
+void block_flush_jit();
+
+/* superinstructions */
+enum { FUSE_NONE, FUSE_CMP_JCC, FUSE_PUSH_MOV, FUSE_LEAVE_RET, FUSE_MOV_ADD, NR_FUSION };
+
+void block_fuse(Block *);
+void fused_exec(BInstr *);
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __DECODE_CACHE_H__
+#define __DECODE_CACHE_H__
+
+#include "cpu/helper.h"
+#include "cpu/decode/modrm.h"
+
+/* A direct-mapped cache of decoded instructions indexed by eip.
+ * An entry keeps the static part of the decoded operands (types,
+ * registers, immediates, effective address components) and the
+ * execute function, so that a hit skips both fetch and decode. For the
+ * specialized handlers of spec.c, which decode faster than a replay,
+ * the entry keeps the handler to call instead. An
+ * entry also keeps the physical page of the instruction, and is valid
+ * only while the page has not been written since.
+ */
+
+#define DCACHE_WIDTH 12
+#define NR_DCACHE (1 << DCACHE_WIDTH)
+
+typedef struct {
+	swaddr_t eip;
+	uint32_t gen;
+	uint32_t page, page_gen;
+	int len;
+	void (*execute) (Operands *);
+	/* if not NULL, called instead of replaying `execute' */
+	int (*helper) (swaddr_t, Operands *);
+	Operands ops;
+} DCache;
+
+/* Cached decodings are valid only if they were made in the current
+ * generation, so flushing every cache built on top is an increment. */
+extern uint32_t dcache_gen;
+
+/* Bumped whenever some cached decodings are dropped, so that code
+ * running them notices a store to itself. */
+extern uint32_t dcache_epoch;
+
+/* the generation of the cached decodings of each physical page */
+extern uint32_t code_gen[];
+
+void dcache_flush();
+uint32_t dcache_code_page(swaddr_t);
+void dcache_mark_code(swaddr_t, int);
+void dcache_write(hwaddr_t, size_t);
+int dcache_decode_exec(swaddr_t, void (**) (Operands *), int (**) (swaddr_t, Operands *), Operands *);
+make_helper(dcache_exec);
+
+/* Re-read the dynamic part of an operand decoded earlier. */
+static inline void dcache_refresh_operand(Operand *op) {
+	if(op->type == OP_TYPE_REG) {
+		switch(op->size) {
+			case 1: op->val = reg_b(op->reg); break;
+			case 2: op->val = reg_w(op->reg); break;
+			default: op->val = reg_l(op->reg); break;
+		}
+	}
+	else if(op->type == OP_TYPE_MEM) {
+		op->addr = operand_addr(op);
+		op->val = mem_read(op->addr, op->size, op->sreg);
+	}
+}
+
+/* Run a specialized handler cached for an instruction without prefixes. */
+static inline void dcache_call(swaddr_t eip, int (*helper) (swaddr_t, Operands *)) {
+	Operands ops = { .is_operand_size_16 = false, .is_address_size_16 = false };
+	helper(eip, &ops);
+}
+
+/* Execute a cached decoding without fetching the instruction again. */
+static inline void dcache_replay(const Operands *cached, void (*execute) (Operands *)) {
+	Operands ops = *cached;
+	dcache_refresh_operand(&ops.src);
+	dcache_refresh_operand(&ops.dest);
+	dcache_refresh_operand(&ops.src2);
+	execute(&ops);
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define __MODRM_H__
 
 #include "common.h"
+#include "cpu/reg.h"
 #include "cpu/decode/operand.h"
 
 /* See i386 manual for more details about instruction format. */
@@ -28,10 +29,32 @@ typedef union {
 	uint8_t val;
 } SIB;
 
-int load_addr(swaddr_t, ModR_M *, Operand *);
-int read_ModR_M(swaddr_t, Operand *, Operand *);
+/* An addressing form, looked up with the ModR/M byte and then with the
+ * SIB byte if `has_sib' is set. */
+typedef struct {
+	int8_t base, index;		/* -1 if not present */
+	uint8_t scale;
+	uint8_t disp_size;
+	bool has_sib;
+} AddrForm;
 
-#define MODRM_ASM_BUF_SIZE 32
-extern char ModR_M_asm[];
+int load_addr(swaddr_t, ModR_M *, Operand *, bool);
+int read_ModR_M(swaddr_t, Operand *, Operand *, bool);
+
+/* The effective address of a memory operand, from the components stored
+ * by load_addr(). A 16-bit address wraps around at 64K. */
+static inline swaddr_t operand_addr(const Operand *op) {
+	if(op->addr16) {
+		uint16_t addr = op->disp;
+		if(op->base != -1) { addr += reg_w(op->base); }
+		if(op->index != -1) { addr += reg_w(op->index); }
+		return addr;
+	}
+
+	swaddr_t addr = op->disp;
+	if(op->base != -1) { addr += reg_l(op->base); }
+	if(op->index != -1) { addr += reg_l(op->index) << op->scale; }
+	return addr;
+}
 
 #endif
@@ -1,13 +1,26 @@
 #ifndef __OPERAND_H__
 #define __OPERAND_H__
 
-enum { OP_TYPE_REG, OP_TYPE_MEM, OP_TYPE_IMM };
+enum { OP_TYPE_REG, OP_TYPE_MEM, OP_TYPE_IMM, OP_TYPE_NONE };
 
-#define OP_STR_SIZE 40
+/* The decoded operands are kept small, since they are copied for every
+ * instruction replayed from the decode cache: an Operand takes 20 bytes,
+ * and Operands fits in a 64-byte cache line.
+ */
 
 typedef struct {
-	uint32_t type;
-	size_t size;
+	uint8_t type;
+	uint8_t size;
+
+	/* components of the effective address of a memory operand,
+	 * `base' and `index' are -1 if not present, `addr16' is set for
+	 * a 16-bit addressing form, and `sreg' is the segment */
+	int8_t base, index;
+	uint8_t scale;
+	bool addr16;
+	uint8_t sreg;
+	int32_t disp;
+
 	union {
 		uint32_t reg;
 		swaddr_t addr;
@@ -15,12 +28,12 @@ typedef struct {
 		int32_t simm;
 	};
 	uint32_t val;
-	char str[OP_STR_SIZE];
 } Operand;
 
 typedef struct {
-	uint32_t opcode;
+	uint16_t opcode;
 	bool is_operand_size_16;
+	bool is_address_size_16;
 	Operand src, dest, src2;
 } Operands;
 
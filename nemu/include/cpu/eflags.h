@@ -2,7 +2,43 @@
 #define __EFLAGS_H__
 
 #include "common.h"
+#include "cpu/reg.h"
 
-void update_eflags_pf_zf_sf(uint32_t);
+/* The kinds of operation recorded in `cpu.lazy_eflags'. The kinds
+ * after EFLAGS_INC leave CF (EFLAGS_PZS also leaves OF) unchanged. */
+enum {
+	EFLAGS_NONE,	/* cpu.eflags is up to date */
+	EFLAGS_ADD, EFLAGS_ADC, EFLAGS_SUB, EFLAGS_SBB, EFLAGS_LOGIC, EFLAGS_NEG,
+	EFLAGS_INC, EFLAGS_DEC,
+	EFLAGS_PZS		/* only PF, ZF and SF, used by shifts */
+};
+
+void eflags_materialize();
+bool eflags_test_cc(int);
+
+/* Bring CF, PF, ZF, SF and OF in `cpu.eflags' up to date. This must be
+ * called before any of them is read or written directly. */
+static inline void eflags_sync() {
+#ifdef LAZY_EFLAGS
+	if(cpu.lazy_eflags.op != EFLAGS_NONE) { eflags_materialize(); }
+#endif
+}
+
+/* Record the arithmetic flags of an operation of `size' bytes.
+ * For EFLAGS_ADC and EFLAGS_SBB the carry in is 1, use EFLAGS_ADD and
+ * EFLAGS_SUB when it is 0. */
+static inline void update_eflags(uint32_t op, size_t size, uint32_t dest, uint32_t src, uint32_t result) {
+#ifdef LAZY_EFLAGS
+	if(op >= EFLAGS_INC) { eflags_sync(); }
+#endif
+	cpu.lazy_eflags.op = op;
+	cpu.lazy_eflags.size = size;
+	cpu.lazy_eflags.dest = dest;
+	cpu.lazy_eflags.src = src;
+	cpu.lazy_eflags.result = result;
+#ifndef LAZY_EFLAGS
+	eflags_materialize();
+#endif
+}
 
 #endif
@@ -27,8 +27,8 @@
 #define REG(index) concat(reg_, SUFFIX) (index)
 #define REG_NAME(index) concat(regs, SUFFIX) [index]
 
-#define MEM_R(addr) swaddr_read(addr, DATA_BYTE)
-#define MEM_W(addr, data) swaddr_write(addr, DATA_BYTE, data)
+#define MEM_R(addr, sreg) mem_read(addr, DATA_BYTE, sreg)
+#define MEM_W(addr, data, sreg) mem_write(addr, DATA_BYTE, data, sreg)
 
 #define OPERAND_W(op, src) concat(write_operand_, SUFFIX) (op, src)
 
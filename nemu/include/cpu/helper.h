@@ -5,27 +5,47 @@
 #include "cpu/decode/operand.h"
 #include "cpu/eflags.h" 
 
-/* All function defined with 'make_helper' return the length of the operation. */
-#define make_helper(name) int name(swaddr_t eip)
+/* All function defined with 'make_helper' return the length of the operation.
+ * The operands are decoded into `ops', which is owned by the caller. */
+#define make_helper(name) int name(swaddr_t eip, Operands *ops)
 
 static inline uint32_t instr_fetch(swaddr_t addr, size_t len) {
-	return swaddr_read(addr, len);
+#ifdef USE_FETCH_WINDOW
+	uint32_t offset = addr - fetch_window.start;
+	if(offset < fetch_window.size && offset + len <= fetch_window.size) {
+		uint8_t *p = fetch_window.host + offset;
+		switch(len) {
+			case 1: return *p;
+			case 2: return unalign_rw(p, 2);
+			default: return unalign_rw(p, 4);
+		}
+	}
+	return instr_fetch_slow(addr, len);
+#else
+	return swaddr_read(addr, len, R_CS);
+#endif
 }
 
-/* Instruction Decode and EXecute */
-static inline int idex(swaddr_t eip, int (*decode)(swaddr_t), void (*execute) (void)) {
+/* Non-NULL while the decode cache is filling an entry, see decode-cache.c. */
+extern void *dcache_fill_entry;
+void dcache_record(const Operands *, void (*) (Operands *));
+void dcache_record_helper(swaddr_t, int (*) (swaddr_t, Operands *));
+
+/* Instruction Decode and EXecute
+ * Helpers built on idex() must not do any work besides decode and
+ * execute, since the decode cache replays only `execute' on a hit.
+ */
+static inline int idex(swaddr_t eip, Operands *ops, int (*decode)(swaddr_t, Operands *), void (*execute) (Operands *)) {
 	/* eip is pointing to the opcode */
-	int len = decode(eip + 1);
-	execute();
+	int len = decode(eip + 1, ops);
+	if(dcache_fill_entry) { dcache_record(ops, execute); }
+	execute(ops);
 	return len + 1;	// "1" for opcode
 }
 
-/* shared by all helper function */
-extern Operands ops_decoded;
-
-#define op_src (&ops_decoded.src)
-#define op_src2 (&ops_decoded.src2)
-#define op_dest (&ops_decoded.dest)
+#define op_src (&ops->src)
+#define op_src2 (&ops->src2)
+#define op_dest (&ops->dest)
 
 
 #endif
@@ -0,0 +1,8 @@
+#ifndef __INTR_H__
+#define __INTR_H__
+
+#include "common.h"
+
+void raise_intr(uint8_t, swaddr_t);
+
+#endif
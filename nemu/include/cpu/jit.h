@@ -0,0 +1,18 @@
+#ifndef __JIT_H__
+#define __JIT_H__
+
+#include "cpu/block.h"
+
+/* Optional translation of hot basic blocks to host x86-64 code,
+ * enabled with `nemu -j'. */
+
+/* A block is translated after it has been run this many times. */
+#define JIT_THRESHOLD 64
+#define JIT_CACHE_SIZE (16 * 1024 * 1024)
+
+extern bool jit_enabled;
+
+void init_jit();
+jit_code_t jit_translate(Block *);
+
+#endif
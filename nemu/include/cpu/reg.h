@@ -10,16 +10,31 @@
 #define esi gpr[R_ESI]._32
 #define edi gpr[R_EDI]._32
 #include "common.h"
+#include "../../../lib-common/x86-inc/cpu.h"
 
 enum { R_EAX, R_ECX, R_EDX, R_EBX, R_ESP, R_EBP, R_ESI, R_EDI };
 enum { R_AX, R_CX, R_DX, R_BX, R_SP, R_BP, R_SI, R_DI };
 enum { R_AL, R_CL, R_DL, R_BL, R_AH, R_CH, R_DH, R_BH };
+enum { R_ES, R_CS, R_SS, R_DS, R_FS, R_GS, NR_SREG };
 //定义了三个枚举类型，分别表示32位、16位和8位寄存器的索引 enum允许程序员为一组相关的整数常量赋予有意义的名称
 //例如 R_EAX 对应 0，R_ECX 对应 1，以此类推
 
 //这反映了i386架构中寄存器的层次结构：32位寄存器（如EAX）、16位寄存器（如AX）和8位寄存器（如AL和AH）。
 //试图实现的功能：提供寄存器索引的映射，方便代码中通过索引访问寄存器。
 
+/* A segment register. The part hidden from the program caches the
+ * descriptor, and is filled only when the selector is loaded, so that
+ * memory accesses never read the GDT. `check_limit' is false for a
+ * segment of 4 GiB, whose limit never needs to be checked.
+ */
+typedef struct {
+	uint16_t selector;
+	uint8_t access;		/* byte 5 of the descriptor: type, S, DPL, P */
+	bool check_limit;
+	uint32_t base;
+	uint32_t limit;		/* in bytes */
+} SegReg;
+
 /* TODO: Re-organize the `CPU_state' structure to match the register
  * encoding scheme in i386 instruction format. For example, if we
  * access cpu.gpr[3]._16, we will get the `bx' register; if we access
@@ -67,7 +82,28 @@ typedef struct {
         };
         uint32_t val;
     } eflags;
+
+    /* the last operation updating the arithmetic flags, which are
+     * computed from it only when they are read, see cpu/eflags.c */
+    struct {
+        uint32_t op;
+        uint32_t size;
+        uint32_t dest, src, result;
+    } lazy_eflags;
 //定义了一个联合体 eflags，包含一个按位定义的结构体和一个32位整数 val，用于表示和操作 EFLAGS 寄存器的各个位标志
+
+    /* control registers, the TLB must be flushed when they change */
+    CR0 cr0;
+    CR3 cr3;
+
+    SegReg sreg[NR_SREG];
+    struct {
+        uint16_t limit;
+        uint32_t base;
+    } gdtr, idtr;
+
+    /* the interrupt request pin, driven by the i8259 */
+    bool INTR;
 } CPU_state;
 //定义了一个名为 CPU_state 的结构体，表示 CPU 的状态，包括通用寄存器、指令指针和标志寄存器
 
@@ -89,6 +125,7 @@ static inline int check_reg_index(int index) {
 extern const char* regsl[];
 extern const char* regsw[];
 extern const char* regsb[];
+extern const char* regss[];
 //声明了三个外部字符串数组，分别表示32位、16位和8位寄存器的名称
 #endif
 //标记完成 
\ No newline at end of file
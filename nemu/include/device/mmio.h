@@ -2,13 +2,25 @@
 #define __MMIO_H__
 
 #include "common.h"
+#include "memory/memory.h"
 
 typedef void(*mmio_callback_t)(hwaddr_t, size_t, bool);
 
 void* add_mmio_map(hwaddr_t, size_t, mmio_callback_t);
-int is_mmio(hwaddr_t);
+void add_mmio_bulk(hwaddr_t, mmio_callback_t);
+
+/* The MMIO region of every physical page, 0 for memory and N + 1 for
+ * region N, so that an access to memory is told apart with one load. */
+#define NR_PHYS_PAGE (1u << (32 - PAGE_WIDTH))
+
+extern uint8_t mmio_page[];
+
+static inline int is_mmio(hwaddr_t addr) {
+	return mmio_page[addr >> PAGE_WIDTH] - 1;
+}
 
 uint32_t mmio_read(hwaddr_t, size_t, int);
 void mmio_write(hwaddr_t, size_t, uint32_t, int);
+void *mmio_bulk(hwaddr_t, size_t, bool, int);
 
 #endif
@@ -5,9 +5,15 @@
 
 typedef void(*pio_callback_t)(ioaddr_t, size_t, bool);
 
+/* Move up to `count' elements of `len' bytes between a port and `buf'
+ * in one call, for rep ins/outs. Return the number of elements moved. */
+typedef size_t(*pio_bulk_callback_t)(ioaddr_t, size_t, void *, size_t, bool);
+
 void* add_pio_map(ioaddr_t, size_t, pio_callback_t);
+void add_pio_bulk(ioaddr_t, pio_bulk_callback_t);
 
 uint32_t pio_read(ioaddr_t, size_t);
 void pio_write(ioaddr_t, size_t, uint32_t);
+size_t pio_bulk(ioaddr_t, size_t, void *, size_t, bool);
 
 #endif
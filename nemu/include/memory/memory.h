@@ -2,6 +2,7 @@
 #define __MEMORY_H__
 
 #include "common.h"
+#include "cpu/reg.h"
 
 #define HW_MEM_SIZE (128 * 1024 * 1024)
 
@@ -19,11 +20,120 @@ extern uint8_t *hw_mem;
 	hwa_to_va(addr); \
 })
 
-uint32_t swaddr_read(swaddr_t, size_t);
+/* Access memory through the DRAM model instead of `hw_mem' directly. */
+extern bool use_dram;
+
+/* A host pointer to the code page the CPU is fetching from. `size' is 0
+ * when the window is invalid. */
+#define FETCH_PAGE_SIZE (PAGE_OFFSET_MASK + 1)
+
+typedef struct {
+	swaddr_t start;
+	uint32_t size;
+	uint8_t *host;
+} FetchWindow;
+
+extern FetchWindow fetch_window;
+uint32_t instr_fetch_slow(swaddr_t, size_t);
+
+/* Flags of each physical page. Stores to a page with PAGE_CODE are
+ * checked against the code cached by the decode cache, and stores to a
+ * page with PAGE_WATCH against the memory watchpoints. Stores to a page
+ * with any flag never take the fast path, so the write TLB entries of
+ * the page must be dropped after a flag is set, see tlb_protect(). */
+#define PAGE_WIDTH 12
+#define PAGE_OFFSET_MASK ((1u << PAGE_WIDTH) - 1)
+#define NR_PAGE (HW_MEM_SIZE >> PAGE_WIDTH)
+
+enum { PAGE_CODE = 0x1, PAGE_WATCH = 0x2 };
+
+extern uint8_t page_flag[];
+
+uint32_t swaddr_read(swaddr_t, size_t, uint8_t);
 uint32_t lnaddr_read(lnaddr_t, size_t);
 uint32_t hwaddr_read(hwaddr_t, size_t);
-void swaddr_write(swaddr_t, size_t, uint32_t);
+void swaddr_write(swaddr_t, size_t, uint32_t, uint8_t);
 void lnaddr_write(lnaddr_t, size_t, uint32_t);
 void hwaddr_write(hwaddr_t, size_t, uint32_t);
 
+/* A host pointer for accessing a range within one page in bulk, or NULL
+ * if the range must be accessed through the usual path. */
+void *swaddr_bulk(swaddr_t, size_t, bool, uint8_t);
+void *hwaddr_bulk(hwaddr_t, size_t, bool);
+
+/* A software TLB in front of the page walk, with separate entries for
+ * reads, writes and instruction fetches. An entry always caches the
+ * translation of its page. When the physical page is plain memory with
+ * the flat backend, and for writes has no flag in `page_flag', `tag'
+ * also matches, and the host address of a virtual address is then
+ * `addend' plus the address. The low bits of the tags hold `tlb_gen',
+ * so the TLB is flushed by bumping it.
+ */
+#define TLB_WIDTH 9
+#define NR_TLB (1 << TLB_WIDTH)
+
+enum { TLB_READ, TLB_WRITE, TLB_FETCH, NR_TLB_TYPE };
+
+typedef struct {
+	uint32_t tag;		/* virtual page | generation, if `addend' is valid */
+	uint32_t ptag;		/* virtual page | generation, if `paddr' is valid */
+	hwaddr_t paddr;		/* physical page */
+	uintptr_t addend;	/* host address minus virtual address */
+} TLBEntry;
+
+extern TLBEntry tlb[NR_TLB_TYPE][NR_TLB];
+extern uint32_t tlb_gen;
+
+static inline TLBEntry *tlb_entry(int type, lnaddr_t addr) {
+	return &tlb[type][(addr >> PAGE_WIDTH) & (NR_TLB - 1)];
+}
+
+static inline uint32_t tlb_tag(lnaddr_t addr) {
+	return (addr & ~PAGE_OFFSET_MASK) | tlb_gen;
+}
+
+void tlb_flush();
+void tlb_protect(hwaddr_t);
+hwaddr_t page_translate(lnaddr_t, int);
+bool page_peek(lnaddr_t, hwaddr_t *);
+
+/* Load a segment register, filling its descriptor cache from the GDT. */
+void load_sreg(uint8_t, uint16_t);
+
+/* Memory accesses of the guest. The common case, an access through a
+ * segment of 4 GiB hitting the TLB within one page, is one add for the
+ * segment base and then a plain load or store to the host memory; the
+ * others go through swaddr_read() and swaddr_write().
+ */
+static inline uint32_t mem_read(swaddr_t addr, size_t len, uint8_t sreg) {
+	const SegReg *s = &cpu.sreg[sreg];
+	lnaddr_t lnaddr = s->base + addr;
+	TLBEntry *e = tlb_entry(TLB_READ, lnaddr);
+	if(!s->check_limit && e->tag == tlb_tag(lnaddr) && (lnaddr & PAGE_OFFSET_MASK) <= PAGE_OFFSET_MASK + 1 - len) {
+		uint8_t *p = (uint8_t *)(e->addend + lnaddr);
+		switch(len) {
+			case 1: return *p;
+			case 2: return unalign_rw(p, 2);
+			default: return unalign_rw(p, 4);
+		}
+	}
+	return swaddr_read(addr, len, sreg);
+}
+
+static inline void mem_write(swaddr_t addr, size_t len, uint32_t data, uint8_t sreg) {
+	const SegReg *s = &cpu.sreg[sreg];
+	lnaddr_t lnaddr = s->base + addr;
+	TLBEntry *e = tlb_entry(TLB_WRITE, lnaddr);
+	if(!s->check_limit && e->tag == tlb_tag(lnaddr) && (lnaddr & PAGE_OFFSET_MASK) <= PAGE_OFFSET_MASK + 1 - len) {
+		uint8_t *p = (uint8_t *)(e->addend + lnaddr);
+		switch(len) {
+			case 1: *p = data; break;
+			case 2: unalign_rw(p, 2) = data; break;
+			default: unalign_rw(p, 4) = data; break;
+		}
+		return;
+	}
+	swaddr_write(addr, len, data, sreg);
+}
+
 #endif
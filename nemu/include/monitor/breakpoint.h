@@ -0,0 +1,34 @@
+#ifndef __BREAKPOINT_H__
+#define __BREAKPOINT_H__
+
+#include "nemu.h"
+#include "monitor/monitor.h"
+
+/* Breakpoints set by the `b' command. Each page of eip holding a
+ * breakpoint has its bit set in `bp_page', so most lookups end there. */
+
+#define NR_BP_PAGE (1 << (32 - PAGE_WIDTH))
+
+extern int nr_bp;
+extern uint32_t bp_page[];
+
+int set_bp(swaddr_t);
+bool delete_bp(int);
+void list_bp();
+int find_bp(swaddr_t);
+
+/* Stop the CPU if there is a breakpoint at `eip'. Called before the
+ * instruction at `eip' runs. */
+static inline bool check_bp(swaddr_t eip) {
+	uint32_t page = eip >> PAGE_WIDTH;
+	if(nr_bp == 0 || !(bp_page[page / 32] & (1u << (page % 32)))) {
+		return false;
+	}
+	int NO = find_bp(eip);
+	if(NO < 0) { return false; }
+	printf("\nHit breakpoint %d at eip = 0x%08x\n", NO, eip);
+	nemu_state = STOP;
+	return true;
+}
+
+#endif
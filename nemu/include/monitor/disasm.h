@@ -0,0 +1,14 @@
+#ifndef __DISASM_H__
+#define __DISASM_H__
+
+#include "common.h"
+
+#define MAX_INSTR_LEN 16
+
+/* Disassemble the instruction at `eip' whose bytes (at most `len') are in
+ * `instr'. The AT&T syntax text is written to `buf' of `size' bytes.
+ * Return the length of the instruction, or 0 if it is not recognized.
+ */
+int disasm(swaddr_t eip, const uint8_t *instr, int len, char *buf, size_t size);
+
+#endif
@@ -5,4 +5,26 @@
 
 uint32_t expr(char *, bool *);
 
+/* An expression compiled into postfix code, see expr.c */
+#define NR_EXPR_CODE 32
+
+typedef struct {
+	int nr_code;
+	struct {
+		int op;
+		uint32_t val;
+	} code[NR_EXPR_CODE];
+
+	/* the inputs of the last run: registers (bit 8 is eip) and memory words */
+	uint32_t reg_mask;
+	uint32_t reg_val[9];
+	int nr_load;
+	hwaddr_t load_addr[NR_EXPR_CODE];
+	uint32_t load_val[NR_EXPR_CODE];
+} ExprCode;
+
+bool expr_compile(char *, ExprCode *);
+uint32_t expr_run(ExprCode *, bool *);
+bool expr_deps_changed(const ExprCode *);
+
 #endif
@@ -1,7 +1,19 @@
 #ifndef __MONITOR_H__
 #define __MONITOR_H__
 
+#include "common.h"
+
 enum { STOP, RUNNING, END };
 extern int nemu_state;
 
+/* Work to be done between instructions. cpu_exec() runs instructions
+ * in batches as long as `pending_events' is zero. */
+enum {
+	EVENT_WATCHPOINT	= 0x1,	/* there are watchpoints to check */
+	EVENT_DEVICE		= 0x2,	/* the timer has fired */
+	EVENT_INTR			= 0x4,	/* an interrupt request is pending */
+	EVENT_TRACE			= 0x8	/* print each instruction as it runs */
+};
+extern volatile uint32_t pending_events;
+
 #endif
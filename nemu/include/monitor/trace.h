@@ -0,0 +1,28 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "monitor/disasm.h"
+
+/* The binary instruction trace written with `nemu -t FILE'. The file
+ * starts with TRACE_MAGIC, followed by one record per instruction.
+ * Use `make trace-dump' to build the tool rendering it as text.
+ */
+
+#define TRACE_MAGIC "NEMUTRC1"
+
+typedef struct {
+	swaddr_t eip;
+	uint8_t len;
+	uint8_t reg_mask;		/* the registers changed by the instruction */
+	uint16_t unused;
+	uint8_t bytes[MAX_INSTR_LEN];
+	uint32_t gpr[8];		/* the registers after the instruction */
+	uint32_t reserved[2];
+} TraceRecord;
+
+extern bool trace_enabled;
+
+void init_trace(const char *);
+void trace_write(swaddr_t, int, const uint8_t *);
+
+#endif
@@ -12,6 +12,9 @@ typedef struct watchpoint {
 	//翻译：如果有必要，添加更多成员
 	char expr[64];              // 存储监视点表达式
     uint32_t value;             // 存储表达式的当前值
+	ExprCode code;              // 编译后的表达式
+	hwaddr_t addr;              // 内存监视点监视的范围，len 为 0 时是表达式监视点
+	size_t len;
 	
 } WP;
 
@@ -19,6 +22,8 @@ WP* get_head_wp();
 
 WP* create_wp(char *expression);
 
+WP* create_mem_wp(hwaddr_t addr, size_t len);
+
 void free_wp(WP* wp); 
 
 #endif
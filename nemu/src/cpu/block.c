@@ -0,0 +1,142 @@
+#include "cpu/jit.h"
+#include "monitor/breakpoint.h"
+
+make_helper(exec);
+
+#ifdef DEBUG
+void trace_instr(swaddr_t, int);
+#endif
+
+static Block blocks[NR_BLOCK];
+
+/* Instructions which may change the control flow end a basic block. */
+static inline bool is_block_end(uint32_t opcode) {
+	switch(opcode) {
+		case 0x70 ... 0x7f:		/* jcc rel8 */
+		case 0x180 ... 0x18f:	/* jcc rel32 */
+		case 0xc2: case 0xc3:	/* ret */
+		case 0xca: case 0xcb:	/* lret */
+		case 0xcc ... 0xcf:		/* int3, int, into, iret */
+		case 0xd6:				/* nemu trap */
+		case 0xe0 ... 0xe3:		/* loop, jecxz */
+		case 0xe8 ... 0xeb:		/* call, jmp */
+		case 0xf4:				/* hlt */
+		case 0xff:				/* group5: indirect call and jmp */
+			return true;
+		default:
+			return false;
+	}
+}
+
+/* Run a block for the first time, recording its instructions. */
+static uint32_t block_build(Block *b, uint32_t n) {
+	uint32_t epoch = dcache_epoch;
+	bool complete = false;
+	swaddr_t end = cpu.eip;
+
+	b->eip = cpu.eip;
+	b->nr_instr = 0;
+	b->exec_count = 0;
+	b->jit_code = NULL;
+	while(b->nr_instr < n) {
+		swaddr_t eip = cpu.eip;
+		/* A block stopped at a breakpoint is not kept, so the cached
+		 * blocks never run over a breakpoint. */
+		if(check_bp(eip)) { break; }
+
+		BInstr *bi = &b->instr[b->nr_instr ++];
+		bi->len = dcache_decode_exec(eip, &bi->execute, &bi->helper, &bi->ops);
+		cpu.eip += bi->len;
+		end = eip + bi->len;
+#ifdef DEBUG
+		trace_instr(eip, bi->len);
+#endif
+
+		if(is_block_end(bi->ops.opcode) || b->nr_instr == MAX_BLOCK_INSTR) {
+			complete = true;
+			break;
+		}
+		if(nemu_state != RUNNING) { break; }
+	}
+
+	/* Blocks cut short by the instruction limit are not worth keeping,
+	 * nor blocks which have written to cached code. */
+	b->gen = 0;
+	if(complete && epoch == dcache_epoch) {
+		int i;
+		b->page[0] = dcache_code_page(b->eip);
+		b->page[1] = dcache_code_page(end - 1);
+		for(i = 0; i < 2; i ++) {
+			b->page_gen[i] = code_gen[b->page[i]];
+		}
+		b->gen = dcache_gen;
+		block_fuse(b);
+	}
+	return b->nr_instr;
+}
+
+static inline bool block_valid(const Block *b) {
+	return b->eip == cpu.eip && b->gen == dcache_gen &&
+		b->page_gen[0] == code_gen[b->page[0]] && b->page_gen[1] == code_gen[b->page[1]];
+}
+
+/* Execute at most `n' instructions, up to the end of the basic block
+ * at cpu.eip. Return the number of instructions executed. */
+uint32_t block_exec(uint32_t n) {
+	Block *b = &blocks[cpu.eip & (NR_BLOCK - 1)];
+	if(!block_valid(b)) {
+		return block_build(b, n);
+	}
+
+	if(jit_enabled && b->nr_instr <= n) {
+		if(b->jit_code == NULL && ++ b->exec_count >= JIT_THRESHOLD) {
+			b->jit_code = jit_translate(b);
+		}
+		if(b->jit_code != NULL) {
+			return b->jit_code();
+		}
+	}
+
+	uint32_t epoch = dcache_epoch;
+	BInstr *bi = b->instr;
+	BInstr *end = b->instr + (b->nr_instr < n ? b->nr_instr : n);
+	for(; bi < end; bi ++) {
+		if(bi->fusion != FUSE_NONE && bi + 1 < end) {
+			fused_exec(bi);
+			bi ++;
+		}
+		else {
+			swaddr_t eip = cpu.eip;
+			if(bi->helper) {
+				dcache_call(eip, bi->helper);
+			}
+			else if(bi->execute) {
+				dcache_replay(&bi->ops, bi->execute);
+			}
+			else {
+				Operands ops = { .is_operand_size_16 = false, .is_address_size_16 = false };
+				exec(eip, &ops);
+			}
+			cpu.eip += bi->len;
+#ifdef DEBUG
+			trace_instr(eip, bi->len);
+#endif
+		}
+
+		/* stop on a trap, or when the block itself has been overwritten */
+		if(nemu_state != RUNNING || epoch != dcache_epoch) {
+			bi ++;
+			break;
+		}
+	}
+	return bi - b->instr;
+}
+
+/* Drop all translated code, called when the JIT code cache is full. */
+void block_flush_jit() {
+	int i;
+	for(i = 0; i < NR_BLOCK; i ++) {
+		blocks[i].jit_code = NULL;
+		blocks[i].exec_count = 0;
+	}
+}
@@ -0,0 +1,164 @@
+#include "cpu/decode/decode-cache.h"
+
+make_helper(exec);
+
+static DCache dcache[NR_DCACHE];
+
+uint32_t dcache_gen = 1;
+uint32_t dcache_epoch = 0;
+
+/* Per physical page, the generation of its cached decodings, and the
+ * 64-byte lines of it holding cached code. */
+uint32_t code_gen[NR_PAGE];
+static uint64_t code_lines[NR_PAGE];
+
+void *dcache_fill_entry = NULL;
+static void (*fill_execute) (Operands *);
+static int (*fill_helper) (swaddr_t, Operands *);
+static swaddr_t fill_helper_eip;
+static Operands *fill_ops;
+static int nr_record;
+
+/* The flags of the pages are left alone, a store to a line marked
+ * before only drops the decodings of its page once more. */
+void dcache_flush() {
+	dcache_gen ++;
+	dcache_epoch ++;
+}
+
+#define CODE_LINE_WIDTH 6
+
+/* the lines from page offset `first' to `last' */
+static inline uint64_t line_mask(uint32_t first, uint32_t last) {
+	return (~0ull >> (63 - (last >> CODE_LINE_WIDTH))) & (~0ull << (first >> CODE_LINE_WIDTH));
+}
+
+/* The physical page holding the byte at `eip'. */
+uint32_t dcache_code_page(swaddr_t eip) {
+	return (page_translate(cpu.sreg[R_CS].base + eip, TLB_FETCH) >> PAGE_WIDTH) & (NR_PAGE - 1);
+}
+
+static void mark_lines(uint32_t page, uint64_t lines) {
+	if(!(page_flag[page] & PAGE_CODE)) {
+		page_flag[page] |= PAGE_CODE;
+		tlb_protect(page << PAGE_WIDTH);
+	}
+	code_lines[page] |= lines;
+}
+
+/* Mark the lines holding the instruction at `eip'. */
+void dcache_mark_code(swaddr_t eip, int len) {
+	lnaddr_t first = cpu.sreg[R_CS].base + eip, last = first + len - 1;
+	if((first ^ last) >> PAGE_WIDTH) {
+		mark_lines(dcache_code_page(eip), line_mask(first & PAGE_OFFSET_MASK, PAGE_OFFSET_MASK));
+		mark_lines(dcache_code_page(eip + len - 1), line_mask(0, last & PAGE_OFFSET_MASK));
+	}
+	else {
+		mark_lines(dcache_code_page(eip), line_mask(first & PAGE_OFFSET_MASK, last & PAGE_OFFSET_MASK));
+	}
+}
+
+static void write_page(hwaddr_t first, hwaddr_t last) {
+	uint32_t page = (first >> PAGE_WIDTH) & (NR_PAGE - 1);
+	if(code_lines[page] & line_mask(first & PAGE_OFFSET_MASK, last & PAGE_OFFSET_MASK)) {
+		code_lines[page] = 0;
+		code_gen[page] ++;
+		page_flag[page] &= ~PAGE_CODE;
+		dcache_epoch ++;
+	}
+}
+
+/* `[addr, addr + len)' is about to be written and touches a page with
+ * PAGE_CODE. If a line holding cached code is overwritten, the cached
+ * decodings of its page are dropped. Data sharing a page with code, but
+ * not a line, is written without dropping anything.
+ */
+void dcache_write(hwaddr_t addr, size_t len) {
+	hwaddr_t last = addr + len - 1;
+	if((addr ^ last) >> PAGE_WIDTH) {
+		write_page(addr, addr | PAGE_OFFSET_MASK);
+		write_page(last & ~PAGE_OFFSET_MASK, last);
+	}
+	else {
+		write_page(addr, last);
+	}
+}
+
+/* Called by idex() between decode and execute on a cache miss. */
+void dcache_record(const Operands *ops, void (*execute) (Operands *)) {
+	nr_record ++;
+	fill_execute = execute;
+	*fill_ops = *ops;
+	fill_ops->is_operand_size_16 = fill_ops->is_address_size_16 = false;
+}
+
+/* Called by the `_fill' handlers of spec.c with their own eip. */
+void dcache_record_helper(swaddr_t eip, int (*helper) (swaddr_t, Operands *)) {
+	fill_helper = helper;
+	fill_helper_eip = eip;
+}
+
+/* Run the instruction at `eip' through the reference path. If it turns
+ * out to be a single decode-execute pair, its decoding is stored to
+ * `ops' and its execute function to `execute', otherwise `execute' is
+ * set to NULL. The specialized handler of the instruction is stored to
+ * `helper' if it has one and no prefix, otherwise `helper' is set to
+ * NULL. The opcode is always stored to `ops->opcode'.
+ */
+int dcache_decode_exec(swaddr_t eip, void (**execute) (Operands *), int (**helper) (swaddr_t, Operands *), Operands *ops) {
+	uint32_t epoch = dcache_epoch;
+	Operands decoded;
+	decoded.is_operand_size_16 = decoded.is_address_size_16 = false;
+	decoded.src.type = decoded.dest.type = decoded.src2.type = OP_TYPE_NONE;
+	nr_record = 0;
+	fill_helper = NULL;
+	fill_ops = ops;
+	dcache_fill_entry = ops;
+	int len = exec(eip, &decoded);
+	dcache_fill_entry = NULL;
+	ops->opcode = decoded.opcode;
+
+	*execute = NULL;
+	*helper = NULL;
+	if(epoch == dcache_epoch) {
+		/* instructions run through exec() every time are marked as
+		 * well, since their length is kept in the blocks */
+		dcache_mark_code(eip, len);
+		if(nr_record == 1) {
+			*execute = fill_execute;
+			/* a handler called past a prefix would miss it */
+			if(fill_helper_eip == eip) { *helper = fill_helper; }
+		}
+	}
+	return len;
+}
+
+make_helper(dcache_exec) {
+	DCache *e = &dcache[eip & (NR_DCACHE - 1)];
+	if(e->eip == eip && e->gen == dcache_gen && e->page_gen == code_gen[e->page]) {
+		if(e->helper) { dcache_call(eip, e->helper); }
+		else { dcache_replay(&e->ops, e->execute); }
+		return e->len;
+	}
+
+	void (*execute) (Operands *);
+	int (*helper) (swaddr_t, Operands *);
+	int len = dcache_decode_exec(eip, &execute, &helper, &e->ops);
+	/* an instruction crossing a page is not cached */
+	lnaddr_t addr = cpu.sreg[R_CS].base + eip;
+	if(execute != NULL && (addr & PAGE_OFFSET_MASK) + len <= PAGE_OFFSET_MASK + 1) {
+		e->eip = eip;
+		e->gen = dcache_gen;
+		e->page = dcache_code_page(eip);
+		e->page_gen = code_gen[e->page];
+		e->len = len;
+		e->execute = execute;
+		e->helper = helper;
+	}
+	else {
+		/* `ops' may have been overwritten */
+		e->gen = 0;
+	}
+
+	return len;
+}
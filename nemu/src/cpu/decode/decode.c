@@ -1,9 +1,6 @@
 #include "common.h"
 #include "cpu/decode/decode.h"
 
-/* shared by all helper function */
-Operands ops_decoded;
-
 #define DATA_BYTE 1
 #include "decode-template.h"
 #undef DATA_BYTE
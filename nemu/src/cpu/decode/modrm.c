@@ -1,89 +1,99 @@
 #include "cpu/decode/modrm.h"
 #include "cpu/helper.h"
 
-int load_addr(swaddr_t eip, ModR_M *m, Operand *rm) {
-	assert(m->mod != 3);
+/* The addressing forms are looked up in tables instead of being worked
+ * out from the fields of ModR/M and SIB for every memory operand. The
+ * tables are indexed by the whole byte, so the entries of a ModR/M
+ * table repeat for the 8 values of the reg field, and mod 3 entries are
+ * never used.
+ */
 
-	int32_t disp = 0;
-	int instr_len, disp_offset, disp_size = 4;
-	int base_reg = -1, index_reg = -1, scale = 0;
-	swaddr_t addr = 0;
-
-	if(m->R_M == R_ESP) {
-		SIB s;
-		s.val = instr_fetch(eip + 1, 1);
-		base_reg = s.base;
-		disp_offset = 2;
-		scale = s.ss;
+#define X8(E, ...) \
+	E(__VA_ARGS__, 0), E(__VA_ARGS__, 1), E(__VA_ARGS__, 2), E(__VA_ARGS__, 3), \
+	E(__VA_ARGS__, 4), E(__VA_ARGS__, 5), E(__VA_ARGS__, 6), E(__VA_ARGS__, 7)
 
-		if(s.index != R_ESP) { index_reg = s.index; }
-	}
-	else {
-		/* no SIB */
-		base_reg = m->R_M;
-		disp_offset = 1;
-	}
+/* 8 rows of the same 8 entries, one row for each value of the reg field */
+#define MOD_ROWS(E, mod) \
+	X8(E, mod), X8(E, mod), X8(E, mod), X8(E, mod), \
+	X8(E, mod), X8(E, mod), X8(E, mod), X8(E, mod)
 
-	if(m->mod == 0) {
-		if(base_reg == R_EBP) { base_reg = -1; }
-		else { disp_size = 0; }
-	}
-	else if(m->mod == 1) { disp_size = 1; }
+#define MODRM_TABLE(E) { MOD_ROWS(E, 0), MOD_ROWS(E, 1), MOD_ROWS(E, 2), MOD_ROWS(E, 3) }
 
-	instr_len = disp_offset;
-	if(disp_size != 0) {
-		/* has disp */
-		disp = instr_fetch(eip + disp_offset, disp_size);
-		if(disp_size == 1) { disp = (int8_t)disp; }
+/* 32-bit addressing. With mod 0, base 5 means disp32 without a base,
+ * in the ModR/M byte as well as in the SIB byte. */
 
-		instr_len += disp_size;
-		addr += disp;
-	}
+#define DISP32(mod, no_base) \
+	((mod) == 0 ? ((no_base) ? 4 : 0) : ((mod) == 1 ? 1 : ((mod) == 2 ? 4 : 0)))
 
-	if(base_reg != -1) {
-		addr += reg_l(base_reg);
-	}
+#define FORM32(mod, rm) { \
+	.base = ((rm) == R_ESP || ((mod) == 0 && (rm) == R_EBP) ? -1 : (rm)), \
+	.index = -1, .scale = 0, \
+	.disp_size = ((rm) == R_ESP ? 0 : DISP32(mod, (rm) == R_EBP)), \
+	.has_sib = ((mod) != 3 && (rm) == R_ESP) }
 
-	if(index_reg != -1) {
-		addr += reg_l(index_reg) << scale;
-	}
+#define SIB_FORM(mod, ss, index_, base_) { \
+	.base = ((mod) == 0 && (base_) == R_EBP ? -1 : (base_)), \
+	.index = ((index_) == R_ESP ? -1 : (index_)), .scale = (ss), \
+	.disp_size = DISP32(mod, (base_) == R_EBP), .has_sib = false }
 
-#ifdef DEBUG
-	char disp_buf[16];
-	char base_buf[8];
-	char index_buf[8];
+#define SIB_SS(mod, ss) \
+	X8(SIB_FORM, mod, ss, 0), X8(SIB_FORM, mod, ss, 1), X8(SIB_FORM, mod, ss, 2), X8(SIB_FORM, mod, ss, 3), \
+	X8(SIB_FORM, mod, ss, 4), X8(SIB_FORM, mod, ss, 5), X8(SIB_FORM, mod, ss, 6), X8(SIB_FORM, mod, ss, 7)
 
-	if(disp_size != 0) {
-		/* has disp */
-		sprintf(disp_buf, "%s%#x", (disp < 0 ? "-" : ""), (disp < 0 ? -disp : disp));
-	}
-	else { disp_buf[0] = '\0'; }
+#define SIB_TABLE(mod) { SIB_SS(mod, 0), SIB_SS(mod, 1), SIB_SS(mod, 2), SIB_SS(mod, 3) }
 
-	if(base_reg == -1) { base_buf[0] = '\0'; }
-	else { 
-		sprintf(base_buf, "%%%s", regsl[base_reg]); 
-	}
+static const AddrForm modrm32_form[256] = MODRM_TABLE(FORM32);
 
-	if(index_reg == -1) { index_buf[0] = '\0'; }
-	else { 
-		sprintf(index_buf, ",%%%s,%d", regsl[index_reg], 1 << scale); 
-	}
+/* indexed by mod and the SIB byte */
+static const AddrForm sib_form[3][256] = { SIB_TABLE(0), SIB_TABLE(1), SIB_TABLE(2) };
+
+/* 16-bit addressing: [bx+si], [bx+di], [bp+si], [bp+di], [si], [di],
+ * [bp], [bx]. With mod 0, rm 6 means disp16 without a base. */
 
-	if(base_reg == -1 && index_reg == -1) {
-		sprintf(rm->str, "%s", disp_buf);
+#define BASE16(rm) ((rm) == 4 ? R_SI : ((rm) == 5 ? R_DI : ((rm) == 2 || (rm) == 3 || (rm) == 6 ? R_BP : R_BX)))
+#define INDEX16(rm) ((rm) >= 4 ? -1 : ((rm) & 1 ? R_DI : R_SI))
+
+#define FORM16(mod, rm) { \
+	.base = ((mod) == 0 && (rm) == 6 ? -1 : BASE16(rm)), \
+	.index = INDEX16(rm), .scale = 0, \
+	.disp_size = ((mod) == 0 ? ((rm) == 6 ? 2 : 0) : ((mod) == 1 ? 1 : ((mod) == 2 ? 2 : 0))), \
+	.has_sib = false }
+
+static const AddrForm modrm16_form[256] = MODRM_TABLE(FORM16);
+
+/* Decode the memory operand whose ModR/M byte is at `eip'. Return the
+ * length of ModR/M, SIB and displacement. */
+int load_addr(swaddr_t eip, ModR_M *m, Operand *rm, bool addr16) {
+	assert(m->mod != 3);
+
+	const AddrForm *f = (addr16 ? &modrm16_form[m->val] : &modrm32_form[m->val]);
+	int disp_offset = 1;
+	if(f->has_sib) {
+		f = &sib_form[m->mod][instr_fetch(eip + 1, 1)];
+		disp_offset = 2;
 	}
-	else {
-		sprintf(rm->str, "%s(%s%s)", disp_buf, base_buf, index_buf);
+
+	int32_t disp = 0;
+	switch(f->disp_size) {
+		case 1: disp = (int8_t)instr_fetch(eip + disp_offset, 1); break;
+		case 2: disp = (int16_t)instr_fetch(eip + disp_offset, 2); break;
+		case 4: disp = instr_fetch(eip + disp_offset, 4); break;
 	}
-#endif
 
 	rm->type = OP_TYPE_MEM;
-	rm->addr = addr;
-
-	return instr_len;
+	rm->base = f->base;
+	rm->index = f->index;
+	rm->scale = f->scale;
+	rm->addr16 = addr16;
+	/* addressing through esp or ebp, or bp in 16 bits, is on the stack */
+	rm->sreg = (f->base == R_ESP || f->base == R_EBP ? R_SS : R_DS);
+	rm->disp = disp;
+	rm->addr = operand_addr(rm);
+
+	return disp_offset + f->disp_size;
 }
 
-int read_ModR_M(swaddr_t eip, Operand *rm, Operand *reg) {
+int read_ModR_M(swaddr_t eip, Operand *rm, Operand *reg, bool addr16) {
 	ModR_M m;
 	m.val = instr_fetch(eip, 1);
 	reg->type = OP_TYPE_REG;
@@ -98,19 +108,11 @@ int read_ModR_M(swaddr_t eip, Operand *rm, Operand *reg) {
 			case 4: rm->val = reg_l(m.R_M); break;
 			default: assert(0);
 		}
-#ifdef DEBUG
-		switch(rm->size) {
-			case 1: sprintf(rm->str, "%%%s", regsb[m.R_M]); break;
-			case 2: sprintf(rm->str, "%%%s", regsw[m.R_M]); break;
-			case 4: sprintf(rm->str, "%%%s", regsl[m.R_M]); break;
-		}
-#endif
 		return 1;
 	}
 	else {
-		int instr_len = load_addr(eip, &m, rm);
-		rm->val = swaddr_read(rm->addr, rm->size);
+		int instr_len = load_addr(eip, &m, rm, addr16);
+		rm->val = mem_read(rm->addr, rm->size, rm->sreg);
 		return instr_len;
 	}
 }
-
@@ -1,15 +1,108 @@
-#include "cpu/reg.h"
+#include "cpu/eflags.h"
 
 static const int parity_table [] = {
-	0, 1, 0, 1,
-	1, 0, 1, 0,
-	0, 1, 0, 1,
-	1, 0, 1, 0
+	0, 1, 1, 0,
+	1, 0, 0, 1,
+	1, 0, 0, 1,
+	0, 1, 1, 0
 };
 
-void update_eflags_pf_zf_sf(uint32_t result) {
+/* Compute the flags of the operation recorded in `cpu.lazy_eflags'. */
+void eflags_materialize() {
+	uint32_t op = cpu.lazy_eflags.op;
+	uint32_t shift = (4 - cpu.lazy_eflags.size) << 3;
+	uint32_t mask = ~0u >> shift;
+	uint32_t sign = 0x80000000u >> shift;
+	uint32_t dest = cpu.lazy_eflags.dest & mask;
+	uint32_t src = cpu.lazy_eflags.src & mask;
+	uint32_t result = cpu.lazy_eflags.result & mask;
+
 	uint8_t temp = result & 0xff;
-	cpu.eflags.PF = parity_table[temp & 0xf] ^ parity_table[temp >> 4];
+	cpu.eflags.PF = !(parity_table[temp & 0xf] ^ parity_table[temp >> 4]);
 	cpu.eflags.ZF = (result == 0);
-	cpu.eflags.SF = result >> 31;
+	cpu.eflags.SF = (result & sign) != 0;
+
+	switch(op) {
+		case EFLAGS_ADD:
+		case EFLAGS_ADC:
+			cpu.eflags.CF = (op == EFLAGS_ADD ? result < dest : result <= dest);
+			cpu.eflags.OF = (~(dest ^ src) & (dest ^ result) & sign) != 0;
+			break;
+		case EFLAGS_SUB:
+		case EFLAGS_SBB:
+			cpu.eflags.CF = (op == EFLAGS_SUB ? dest < src : dest <= src);
+			cpu.eflags.OF = ((dest ^ src) & (dest ^ result) & sign) != 0;
+			break;
+		case EFLAGS_LOGIC:
+			cpu.eflags.CF = cpu.eflags.OF = 0;
+			break;
+		case EFLAGS_NEG:
+			cpu.eflags.CF = (result != 0);
+			cpu.eflags.OF = (result == sign);
+			break;
+		case EFLAGS_INC:
+			cpu.eflags.OF = (result == sign);
+			break;
+		case EFLAGS_DEC:
+			cpu.eflags.OF = (result == sign - 1);
+			break;
+		default: break;
+	}
+
+	cpu.lazy_eflags.op = EFLAGS_NONE;
+}
+
+/* Evaluate the condition `cc' of jcc and setcc, which is the low 4 bits
+ * of their opcodes. After cmp and test, the conditions other than PF
+ * are computed from the recorded operands without materializing the
+ * flags.
+ */
+bool eflags_test_cc(int cc) {
+	uint32_t op = cpu.lazy_eflags.op;
+	bool r;
+
+	if((op == EFLAGS_SUB || op == EFLAGS_LOGIC) && (cc >> 1) != 5) {
+		uint32_t shift = (4 - cpu.lazy_eflags.size) << 3;
+		uint32_t sign = 0x80000000u >> shift;
+		uint32_t dest = cpu.lazy_eflags.dest & (~0u >> shift);
+		uint32_t src = cpu.lazy_eflags.src & (~0u >> shift);
+		uint32_t result = cpu.lazy_eflags.result & (~0u >> shift);
+		int32_t sdest = (int32_t)(dest << shift);
+		int32_t ssrc = (int32_t)(src << shift);
+
+		if(op == EFLAGS_SUB) {
+			switch(cc >> 1) {
+				case 0: r = ((dest ^ src) & (dest ^ result) & sign) != 0; break;	/* o */
+				case 1: r = dest < src; break;		/* b */
+				case 2: r = dest == src; break;		/* e */
+				case 3: r = dest <= src; break;		/* be */
+				case 4: r = (result & sign) != 0; break;	/* s */
+				case 6: r = sdest < ssrc; break;	/* l */
+				default: r = sdest <= ssrc; break;	/* le */
+			}
+		}
+		else {
+			/* CF = OF = 0 */
+			switch(cc >> 1) {
+				case 0: case 1: r = false; break;
+				case 2: case 3: r = (result == 0); break;
+				case 4: case 6: r = (result & sign) != 0; break;
+				default: r = (result == 0 || (result & sign) != 0); break;
+			}
+		}
+		return r ^ (cc & 1);
+	}
+
+	eflags_sync();
+	switch(cc >> 1) {
+		case 0: r = cpu.eflags.OF; break;
+		case 1: r = cpu.eflags.CF; break;
+		case 2: r = cpu.eflags.ZF; break;
+		case 3: r = cpu.eflags.CF || cpu.eflags.ZF; break;
+		case 4: r = cpu.eflags.SF; break;
+		case 5: r = cpu.eflags.PF; break;
+		case 6: r = cpu.eflags.SF != cpu.eflags.OF; break;
+		default: r = cpu.eflags.ZF || cpu.eflags.SF != cpu.eflags.OF; break;
+	}
+	return r ^ (cc & 1);
 }
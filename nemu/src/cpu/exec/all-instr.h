@@ -15,6 +15,7 @@
 #include "arith/mul.h"
 #include "arith/idiv.h"
 #include "arith/div.h"
+#include "arith/add.h"
 #include "arith/sub.h"
 #include "arith/adc.h"
 #include "arith/sbb.h"
@@ -36,9 +37,16 @@
 
 #include "string/rep.h"
 #include "string/movs.h"
+#include "string/cmps.h"
 #include "string/scas.h"
 #include "string/stos.h"
 
+#include "io/in.h"
+#include "io/out.h"
+
 #include "misc/misc.h"
+#include "system/system.h"
 
 #include "special/special.h"
+
+#include "spec/spec.h"
@@ -0,0 +1,20 @@
+#include "cpu/exec/template-start.h"
+
+#define instr add
+
+static void do_execute(Operands *ops) {
+	DATA_TYPE result = op_dest->val + op_src->val;
+	OPERAND_W(op_dest, result);
+
+	update_eflags(EFLAGS_ADD, DATA_BYTE, op_dest->val, op_src->val, result);
+}
+
+make_instr_helper(i2a)
+make_instr_helper(i2rm)
+#if DATA_BYTE == 2 || DATA_BYTE == 4
+make_instr_helper(si2rm)
+#endif
+make_instr_helper(r2rm)
+make_instr_helper(rm2r)
+
+#include "cpu/exec/template-end.h"
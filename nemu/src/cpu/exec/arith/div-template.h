@@ -2,7 +2,7 @@
 
 #define instr div
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	uint64_t a;
 	uint32_t b = (DATA_TYPE)op_src->val;
 #if DATA_BYTE == 1
@@ -12,8 +12,6 @@ static void do_execute() {
 #endif
 	REG(R_EAX) = a / b;
 	REG(R_EDX) = a % b;
-
-	print_asm_template1();
 }
 
 make_instr_helper(rm)
@@ -2,7 +2,7 @@
 
 #define instr idiv
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	int64_t a;
 	int32_t b = (DATA_TYPE_S)op_src->val;
 #if DATA_BYTE == 1
@@ -12,8 +12,6 @@ static void do_execute() {
 #endif
 	REG(R_EAX) = a / b;
 	REG(R_EDX) = a % b;
-
-	print_asm_template1();
 }
 
 make_instr_helper(rm)
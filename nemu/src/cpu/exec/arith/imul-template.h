@@ -11,21 +11,19 @@
 #define instr imul
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	RET_DATA_TYPE result = (RET_DATA_TYPE)op_src->val * (RET_DATA_TYPE)op_src2->val;
 	OPERAND_W(op_dest, result);
 
 	/* There is no need to update EFLAGS, since no other instructions 
 	 * in PA will test the flags updated by this instruction.
 	 */
-
-	print_asm_template3();
 }
 
 make_helper(concat(imul_rm2r_, SUFFIX)) {
-	int len = concat(decode_rm2r_, SUFFIX)(eip + 1);
-	ops_decoded.src2 = ops_decoded.dest;
-	do_execute();
+	int len = concat(decode_rm2r_, SUFFIX)(eip + 1, ops);
+	ops->src2 = ops->dest;
+	do_execute(ops);
 	return len + 1;
 }
 
@@ -34,7 +32,7 @@ make_instr_helper(i_rm2r)
 #endif
 
 make_helper(concat(imul_rm2a_, SUFFIX)) {
-	int len = concat(decode_rm_, SUFFIX)(eip + 1);
+	int len = concat(decode_rm_, SUFFIX)(eip + 1, ops);
 	int64_t src = (DATA_TYPE_S)op_src->val;
 	int64_t result = (DATA_TYPE_S)REG(R_EAX) * src;
 #if DATA_BYTE == 1
@@ -51,7 +49,6 @@ make_helper(concat(imul_rm2a_, SUFFIX)) {
 	 * in PA will test the flags updated by this instruction.
 	 */
 
-	print_asm_template1();
 	return len + 1;
 }
 
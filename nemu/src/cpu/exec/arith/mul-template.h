@@ -2,7 +2,7 @@
 
 #define instr mul
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	uint64_t src = op_src->val;
 	uint64_t result = REG(R_EAX) * src;
 #if DATA_BYTE == 1
@@ -18,8 +18,6 @@ static void do_execute() {
 	/* There is no need to update EFLAGS, since no other instructions 
 	 * in PA will test the flags updated by this instruction.
 	 */
-
-	print_asm_template1();
 }
 
 make_instr_helper(rm)
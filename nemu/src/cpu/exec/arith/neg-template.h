@@ -2,15 +2,11 @@
 
 #define instr neg
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = -op_src->val;
 	OPERAND_W(op_src, result);
 
-	/* There is no need to update EFLAGS, since no other instructions 
-	 * in PA will test the flags updated by this instruction.
-	 */
-
-	print_asm_template1();
+	update_eflags(EFLAGS_NEG, DATA_BYTE, 0, op_src->val, result);
 }
 
 make_instr_helper(rm)
@@ -2,16 +2,13 @@
 
 #define instr sbb
 
-static void do_execute () {
-	DATA_TYPE result = op_dest->val - (op_src->val + cpu.eflags.CF);
+static void do_execute(Operands *ops) {
+	eflags_sync();
+	uint32_t cf = cpu.eflags.CF;
+	DATA_TYPE result = op_dest->val - (op_src->val + cf);
 	OPERAND_W(op_dest, result);
 
-	/* TODO: Update EFLAGS. */
-	update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-	cpu.eflags.CF = result < op_dest->val;
-	cpu.eflags.OF = MSB(~(op_dest->val ^ op_src->val) & (op_dest->val ^ result));
-
-	print_asm_template2();
+	update_eflags(cf ? EFLAGS_SBB : EFLAGS_SUB, DATA_BYTE, op_dest->val, op_src->val, result);
 }
 
 make_instr_helper(r2rm)
@@ -2,15 +2,11 @@
 
 #define instr sub
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = op_dest->val - op_src->val;
 	OPERAND_W(op_dest, result);
 
-	update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-	cpu.eflags.CF = result > op_dest->val;
-	cpu.eflags.OF = MSB((op_dest->val ^ op_src->val) & (op_dest->val ^ result));
-
-	print_asm_template2();
+	update_eflags(EFLAGS_SUB, DATA_BYTE, op_dest->val, op_src->val, result);
 }
 
 make_instr_helper(i2rm)
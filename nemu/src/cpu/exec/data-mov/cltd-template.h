@@ -4,7 +4,6 @@
 make_helper(concat(cltd_, SUFFIX)) {
 	REG(R_EDX) = -(MSB(REG(R_EAX)));
 
-	print_asm("cltd" str(SUFFIX));
 	return 1;
 }
 
@@ -15,7 +14,6 @@ make_helper(concat(cwtl_, SUFFIX)) {
 	reg_l(R_EAX) = (int16_t)reg_w(R_AX);
 #endif
 
-	print_asm("cwtl" str(SUFFIX));
 	return 1;
 }
 #endif
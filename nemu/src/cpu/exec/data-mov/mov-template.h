@@ -2,9 +2,8 @@
 
 #define instr mov
 
-static void do_execute() {
+static void do_execute(Operands *ops) {
 	OPERAND_W(op_dest, op_src->val);
-	print_asm_template2();
 }
 
 make_instr_helper(i2r)
@@ -14,17 +13,15 @@ make_instr_helper(rm2r)
 
 make_helper(concat(mov_a2moffs_, SUFFIX)) {
 	swaddr_t addr = instr_fetch(eip + 1, 4);
-	MEM_W(addr, REG(R_EAX));
+	MEM_W(addr, REG(R_EAX), R_DS);
 
-	print_asm("mov" str(SUFFIX) " %%%s,0x%x", REG_NAME(R_EAX), addr);
 	return 5;
 }
 
 make_helper(concat(mov_moffs2a_, SUFFIX)) {
 	swaddr_t addr = instr_fetch(eip + 1, 4);
-	REG(R_EAX) = MEM_R(addr);
+	REG(R_EAX) = MEM_R(addr, R_DS);
 
-	print_asm("mov" str(SUFFIX) " 0x%x,%%%s", addr, REG_NAME(R_EAX));
 	return 5;
 }
 
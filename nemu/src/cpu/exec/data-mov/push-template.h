@@ -4,19 +4,18 @@
 #define instr push
 
 // 实现push指令的核心执行逻辑
-static void do_execute() {
+static void do_execute(Operands *ops) {
     // 将源操作数的值写入栈顶（esp-4位置），使用4字节写入
     // 参数说明：
     // - cpu.esp - 4: 栈顶上方4字节的位置（栈向低地址增长）
     // - 4: 写入的数据长度（4字节，32位）
     // - op_src->val: 源操作数的值
-    swaddr_write(cpu.esp - 4, 4, op_src->val);
+    mem_write(cpu.esp - 4, 4, op_src->val, R_SS);
     
     // 更新栈指针，模拟栈的push操作（栈指针减4，因为栈向低地址增长）
     cpu.esp -= 4;
     
     // 打印反汇编信息，template1表示单操作数指令
-    print_asm_template1();
 }
 
 // 条件编译：只有在操作数大小为2或4字节时才生成以下helper函数
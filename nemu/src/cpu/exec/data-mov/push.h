@@ -3,8 +3,8 @@
 
 make_helper(push_si_b);
 
-make_helper(push_r);  
-make_helper(push_rm);
+make_helper(push_r_v);
+make_helper(push_rm_v);
 
 
 #endif
\ No newline at end of file
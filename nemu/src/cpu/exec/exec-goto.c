@@ -0,0 +1,173 @@
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+#include "monitor/monitor.h"
+
+/* An interpreter loop dispatching with GCC computed gotos. The most
+ * frequent instructions are decoded and executed right in the loop, so
+ * that each of them costs one indirect jump instead of the calls
+ * through opcode_table[], idex(), decode and execute. All the others,
+ * including every instruction with a prefix, fall back to opcode_table[],
+ * which stays the reference implementation.
+ */
+
+typedef int (*helper_fun)(swaddr_t, Operands *);
+extern helper_fun opcode_table[];
+
+/* set with `nemu -g' */
+bool goto_core_enabled = false;
+
+#ifdef DEBUG
+void trace_instr(swaddr_t, int);
+#endif
+
+/* Execute at most `n' instructions. Return the number of instructions
+ * executed. */
+uint32_t exec_goto(uint32_t n) {
+	static const void *dispatch[256] = {
+		[0 ... 255] = &&other,
+		[0x29] = &&sub_r2rm_l,
+		[0x31] = &&xor_r2rm_l,
+		[0x39] = &&cmp_r2rm_l,
+		[0x40 ... 0x47] = &&inc_r_l,
+		[0x48 ... 0x4f] = &&dec_r_l,
+		[0x74] = &&je_b,
+		[0x75] = &&jne_b,
+		[0x85] = &&test_r2rm_l,
+		[0x89] = &&mov_r2rm_l,
+		[0x8b] = &&mov_rm2r_l,
+		[0x90] = &&nop,
+		[0xb8 ... 0xbf] = &&mov_i2r_l,
+		[0xe9] = &&jmp_si_l,
+		[0xeb] = &&jmp_si_b,
+	};
+
+	uint32_t nr_exec = 0;
+	Operands ops = { .is_operand_size_16 = false, .is_address_size_16 = false };
+	swaddr_t eip;
+	uint8_t opcode;
+	ModR_M m;
+#ifdef DEBUG
+	int len;
+#endif
+
+	/* Fetch the opcode at cpu.eip and jump to its handler. */
+#define DISPATCH() do { \
+		eip = cpu.eip; \
+		opcode = instr_fetch(eip, 1); \
+		goto *dispatch[opcode]; \
+	} while(0)
+
+	/* Finish the current instruction of length `l'. Return to cpu_exec()
+	 * when an event needs the slow path. */
+#ifdef DEBUG
+#define NEXT(l) do { \
+		len = (l); \
+		cpu.eip += len; \
+		nr_exec ++; \
+		trace_instr(eip, len); \
+		if(nr_exec == n || nemu_state != RUNNING || pending_events != 0) { return nr_exec; } \
+		DISPATCH(); \
+	} while(0)
+#else
+#define NEXT(l) do { \
+		cpu.eip += (l); \
+		if(++ nr_exec == n || nemu_state != RUNNING || pending_events != 0) { return nr_exec; } \
+		DISPATCH(); \
+	} while(0)
+#endif
+
+	/* Handlers of `r32, r/m32' forms fall back unless r/m is a register. */
+#define FETCH_MODRM_REG() do { \
+		m.val = instr_fetch(eip + 1, 1); \
+		if(m.mod != 3) { goto other; } \
+	} while(0)
+
+	DISPATCH();
+
+other:
+	ops.opcode = opcode;
+	NEXT(opcode_table[opcode](eip, &ops));
+
+nop:
+	NEXT(1);
+
+mov_i2r_l:
+	reg_l(opcode & 0x7) = instr_fetch(eip + 1, 4);
+	NEXT(5);
+
+mov_r2rm_l:
+	FETCH_MODRM_REG();
+	reg_l(m.R_M) = reg_l(m.reg);
+	NEXT(2);
+
+mov_rm2r_l:
+	FETCH_MODRM_REG();
+	reg_l(m.reg) = reg_l(m.R_M);
+	NEXT(2);
+
+inc_r_l: {
+		uint32_t dest = reg_l(opcode & 0x7);
+		reg_l(opcode & 0x7) = dest + 1;
+		update_eflags(EFLAGS_INC, 4, dest, 1, dest + 1);
+		NEXT(1);
+	}
+
+dec_r_l: {
+		uint32_t dest = reg_l(opcode & 0x7);
+		reg_l(opcode & 0x7) = dest - 1;
+		update_eflags(EFLAGS_DEC, 4, dest, 1, dest - 1);
+		NEXT(1);
+	}
+
+sub_r2rm_l: {
+		FETCH_MODRM_REG();
+		uint32_t dest = reg_l(m.R_M), src = reg_l(m.reg);
+		reg_l(m.R_M) = dest - src;
+		update_eflags(EFLAGS_SUB, 4, dest, src, dest - src);
+		NEXT(2);
+	}
+
+cmp_r2rm_l: {
+		FETCH_MODRM_REG();
+		uint32_t dest = reg_l(m.R_M), src = reg_l(m.reg);
+		update_eflags(EFLAGS_SUB, 4, dest, src, dest - src);
+		NEXT(2);
+	}
+
+xor_r2rm_l: {
+		FETCH_MODRM_REG();
+		uint32_t result = reg_l(m.R_M) ^ reg_l(m.reg);
+		reg_l(m.R_M) = result;
+		update_eflags(EFLAGS_LOGIC, 4, 0, 0, result);
+		NEXT(2);
+	}
+
+test_r2rm_l: {
+		FETCH_MODRM_REG();
+		uint32_t result = reg_l(m.R_M) & reg_l(m.reg);
+		update_eflags(EFLAGS_LOGIC, 4, 0, 0, result);
+		NEXT(2);
+	}
+
+jmp_si_b:
+	cpu.eip += (int8_t)instr_fetch(eip + 1, 1);
+	NEXT(2);
+
+jmp_si_l:
+	cpu.eip += instr_fetch(eip + 1, 4);
+	NEXT(5);
+
+je_b:
+	eflags_sync();
+	if(cpu.eflags.ZF) { cpu.eip += (int8_t)instr_fetch(eip + 1, 1); }
+	NEXT(2);
+
+jne_b:
+	eflags_sync();
+	if(!cpu.eflags.ZF) { cpu.eip += (int8_t)instr_fetch(eip + 1, 1); }
+	NEXT(2);
+
+#undef DISPATCH
+#undef NEXT
+#undef FETCH_MODRM_REG
+}
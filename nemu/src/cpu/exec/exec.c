@@ -3,7 +3,7 @@
 
 #include "all-instr.h"
 
-typedef int (*helper_fun)(swaddr_t);
+typedef int (*helper_fun)(swaddr_t, Operands *);
 
 /*此处对helper_fun进行了类型定义，具体来说：
 typedef：类型定义关键字，用于创建新类型别名
@@ -23,22 +23,22 @@ static make_helper(_2byte_esc);
 	static make_helper(name) { \
 		ModR_M m; \
 		m.val = instr_fetch(eip + 1, 1); \
-		return concat(opcode_table_, name) [m.opcode](eip); \
+		return concat(opcode_table_, name) [m.opcode](eip, ops); \
 	}
 	
 /* 0x80 */
 make_group(group1_b,
-	inv, inv, inv, inv, 
+	add_i2rm_b, inv, inv, inv, 
 	and_i2rm_b, inv, inv, inv)
 
 /* 0x81 */
 make_group(group1_v,
-	inv, inv, inv, inv, 
+	add_i2rm_v, inv, inv, inv, 
 	and_i2rm_v, sub_i2rm_v, inv, inv)
 
 /* 0x83 */
 make_group(group1_sx_v,
-	inv, or_si2rm_v, inv, inv, 
+	add_si2rm_v, or_si2rm_v, inv, inv, 
 	and_si2rm_v, sub_si2rm_v, inv, inv)
 
 /* 0xc0 */
@@ -96,26 +96,26 @@ make_group(group6,
 	inv, inv, inv, inv)
 
 make_group(group7,
-	inv, inv, inv, inv, 
-	inv, inv, inv, inv)
+	inv, inv, lgdt, lidt, 
+	inv, inv, inv, invlpg)
 
 
 /* TODO: Add more instructions!!! */
 
 helper_fun opcode_table [256] = {
-///* 0x00 */	inv, add_r2rm_v, inv, add_rm2r_v,
-// /* 0x04 */	inv, add_i2a_v, inv, inv,
-/* 0x08 */	inv, or_r2rm_v, or_rm2r_b, inv,
+/* 0x00 */	add_r2rm_b, add_r2rm_v, add_rm2r_b, add_rm2r_v,
+/* 0x04 */	add_i2a_b, add_i2a_v, inv, inv,
+/* 0x08 */	spec_or_r2rm_b, spec_or_r2rm_v, spec_or_rm2r_b, spec_or_rm2r_v,
 /* 0x0c */	or_i2a_b, or_i2a_v, inv, _2byte_esc,
 /* 0x10 */	inv, adc_r2rm_v, inv, inv,
 /* 0x14 */	inv, inv, inv, inv,
 /* 0x18 */	inv, sbb_r2rm_v, inv, inv,
 /* 0x1c */	inv, inv, inv, inv,
-/* 0x20 */	inv, and_r2rm_v, and_rm2r_b, inv,
+/* 0x20 */	spec_and_r2rm_b, spec_and_r2rm_v, spec_and_rm2r_b, spec_and_rm2r_v,
 /* 0x24 */	inv, and_i2a_v, inv, inv,
-/* 0x28 */	inv, sub_r2rm_v, inv, sub_rm2r_v,
+/* 0x28 */	spec_sub_r2rm_b, spec_sub_r2rm_v, spec_sub_rm2r_b, spec_sub_rm2r_v,
 /* 0x2c */	inv, inv, inv, inv,
-/* 0x30 */	inv, xor_r2rm_v, inv, inv,
+/* 0x30 */	spec_xor_r2rm_b, spec_xor_r2rm_v, spec_xor_rm2r_b, spec_xor_rm2r_v,
 /* 0x34 */	inv, inv, inv, inv,
 /* 0x38 */	cmp_r2rm_b, cmp_r2rm_v, cmp_rm2r_b, cmp_rm2r_v,
 /* 0x3c */	cmp_i2a_b, cmp_i2a_v, inv, inv,
@@ -123,50 +123,50 @@ helper_fun opcode_table [256] = {
 /* 0x44 */	inv, inc_r_v, inc_r_v, inc_r_v,
 /* 0x48 */	dec_r_v, dec_r_v, dec_r_v, dec_r_v,
 /* 0x4c */	inv, dec_r_v,dec_r_v,dec_r_v,
-// /* 0x50 */	push_r_v, push_r_v, push_r_v, push_r_v,
-// /* 0x54 */	push_r_v, push_r_v, push_r_v, push_r_v,
+/* 0x50 */	push_r_v, push_r_v, push_r_v, push_r_v,
+/* 0x54 */	push_r_v, push_r_v, push_r_v, push_r_v,
 /* 0x58 */	pop_r_v, pop_r_v, pop_r_v, pop_r_v,
 /* 0x5c */	inv, pop_r_v, pop_r_v, pop_r_v,
 /* 0x60 */	inv, inv, inv, inv,
-/* 0x64 */	inv, inv, operand_size, inv,
+/* 0x64 */	inv, inv, operand_size, address_size,
 /* 0x68 */	inv, imul_i_rm2r_v, push_si_b, imul_si_rm2r_v,
-/* 0x6c */	inv, inv, inv, inv,
+/* 0x6c */	ins_b, ins_v, outs_b, outs_v,
 /* 0x70 */	inv, inv, jb_b, inv,
 /* 0x74 */	je_b, jne_b, jbe_b, ja_b,
 /* 0x78 */	js_b, jns_b, inv, inv,
 /* 0x7c */	jl_b, jge_b, jle_b, jg_b,
 /* 0x80 */	group1_b, group1_v, inv, group1_sx_v, 
 /* 0x84 */	test_r2rm_b, test_r2rm_v, inv, inv,
-/* 0x88 */	mov_r2rm_b, mov_r2rm_v, mov_rm2r_b, mov_rm2r_v,
-/* 0x8c */	inv, lea, inv, inv,
+/* 0x88 */	spec_mov_r2rm_b, spec_mov_r2rm_v, spec_mov_rm2r_b, spec_mov_rm2r_v,
+/* 0x8c */	mov_sreg2rm, lea, mov_rm2sreg, inv,
 /* 0x90 */	nop, inv, inv, inv,
 /* 0x94 */	inv, inv, inv, inv,
 /* 0x98 */	cwtl_v, cltd_v, inv, inv,
 /* 0x9c */	inv, inv, inv, inv,
 /* 0xa0 */	mov_moffs2a_b, mov_moffs2a_v, mov_a2moffs_b, mov_a2moffs_v,
-/* 0xa4 */	movs_b, movs_v, inv, inv,
+/* 0xa4 */	movs_b, movs_v, cmps_b, cmps_v,
 /* 0xa8 */	inv, inv, stos_b, stos_v,
-// /* 0xac */	lods_b, inv, scas_b, inv,
+/* 0xac */	inv, inv, scas_b, scas_v,
 /* 0xb0 */	mov_i2r_b, mov_i2r_b, mov_i2r_b, mov_i2r_b,
 /* 0xb4 */	mov_i2r_b, mov_i2r_b, mov_i2r_b, mov_i2r_b,
 /* 0xb8 */	mov_i2r_v, mov_i2r_v, mov_i2r_v, mov_i2r_v, 
 /* 0xbc */	mov_i2r_v, mov_i2r_v, mov_i2r_v, mov_i2r_v, 
 /* 0xc0 */	group2_i_b, group2_i_v, ret_i, ret,
 /* 0xc4 */	inv, inv, mov_i2rm_b, mov_i2rm_v,
-// /* 0xc8 */	inv, leave, inv, inv,
-/* 0xcc */	int3, inv, inv, inv,
+/* 0xc8 */	inv, leave, inv, inv,
+/* 0xcc */	int3, int_i, inv, iret,
 /* 0xd0 */	group2_1_b, group2_1_v, group2_cl_b, group2_cl_v,
 /* 0xd4 */	inv, inv, nemu_trap, inv,
 /* 0xd8 */	inv, inv, inv, inv,
 /* 0xdc */	inv, inv, inv, inv,
 /* 0xe0 */	inv, inv, inv, inv,
-/* 0xe4 */	inv, inv, inv, inv,
-/* 0xe8 */	call_si, jmp_si_l, inv, jmp_si_b,
-/* 0xec */	inv, inv, inv, inv,
+/* 0xe4 */	in_i2a_b, in_i2a_v, out_a2i_b, out_a2i_v,
+/* 0xe8 */	call_si, jmp_si_l, ljmp, jmp_si_b,
+/* 0xec */	in_d2a_b, in_d2a_v, out_a2d_b, out_a2d_v,
 /* 0xf0 */	inv, inv, repnz, rep,
 /* 0xf4 */	inv, inv, group3_b, group3_v,
-/* 0xf8 */	inv, inv, inv, inv,
-/* 0xfc */	inv, inv, group4, group5
+/* 0xf8 */	inv, inv, cli, sti,
+/* 0xfc */	cld, std, group4, group5
 };
 
 helper_fun _2byte_opcode_table [256] = {
@@ -178,7 +178,7 @@ helper_fun _2byte_opcode_table [256] = {
 /* 0x14 */	inv, inv, inv, inv, 
 /* 0x18 */	inv, inv, inv, inv, 
 /* 0x1c */	inv, inv, inv, inv, 
-/* 0x20 */	inv, inv, inv, inv, 
+/* 0x20 */	mov_cr2r, inv, mov_r2cr, inv, 
 /* 0x24 */	inv, inv, inv, inv,
 /* 0x28 */	inv, inv, inv, inv, 
 /* 0x2c */	inv, inv, inv, inv, 
@@ -207,7 +207,7 @@ helper_fun _2byte_opcode_table [256] = {
 /* 0x88 */	inv, inv, inv, inv, 
 /* 0x8c */	jl_l, jge_l, jle_l, inv, 
 /* 0x90 */	inv, inv, inv, inv,
-// /* 0x94 */	inv, setne, inv, inv,
+/* 0x94 */	inv, inv, inv, inv,
 /* 0x98 */	inv, inv, inv, inv, 
 /* 0x9c */	inv, inv, inv, inv, 
 /* 0xa0 */	inv, inv, inv, inv, 
@@ -237,15 +237,15 @@ helper_fun _2byte_opcode_table [256] = {
 };
 
 make_helper(exec) {
-	ops_decoded.opcode = instr_fetch(eip, 1);
-	return opcode_table[ ops_decoded.opcode ](eip);
+	ops->opcode = instr_fetch(eip, 1);
+	return opcode_table[ ops->opcode ](eip, ops);
 }
 
 
 static make_helper(_2byte_esc) {
 	eip ++;
 	uint32_t opcode = instr_fetch(eip, 1);
-	ops_decoded.opcode = opcode | 0x100;
-	return _2byte_opcode_table[opcode](eip) + 1; 
+	ops->opcode = opcode | 0x100;
+	return _2byte_opcode_table[opcode](eip, ops) + 1; 
 	//sadasdsa
 }
@@ -0,0 +1,26 @@
+#include "cpu/exec/template-start.h"
+
+#define instr in
+
+/* in imm8, eAX */
+make_helper(concat(in_i2a_, SUFFIX)) {
+	REG(R_EAX) = pio_read(instr_fetch(eip + 1, 1), DATA_BYTE);
+
+	return 2;
+}
+
+/* in (%dx), eAX */
+make_helper(concat(in_d2a_, SUFFIX)) {
+	REG(R_EAX) = pio_read(reg_w(R_DX), DATA_BYTE);
+
+	return 1;
+}
+
+make_helper(concat(ins_, SUFFIX)) {
+	MEM_W(cpu.edi, pio_read(reg_w(R_DX), DATA_BYTE), R_ES);
+	cpu.edi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,26 @@
+#include "cpu/exec/template-start.h"
+
+#define instr out
+
+/* out eAX, imm8 */
+make_helper(concat(out_a2i_, SUFFIX)) {
+	pio_write(instr_fetch(eip + 1, 1), DATA_BYTE, REG(R_EAX));
+
+	return 2;
+}
+
+/* out eAX, (%dx) */
+make_helper(concat(out_a2d_, SUFFIX)) {
+	pio_write(reg_w(R_DX), DATA_BYTE, REG(R_EAX));
+
+	return 1;
+}
+
+make_helper(concat(outs_, SUFFIX)) {
+	pio_write(reg_w(R_DX), DATA_BYTE, MEM_R(cpu.esi, R_DS));
+	cpu.esi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
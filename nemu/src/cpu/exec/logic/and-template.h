@@ -2,15 +2,11 @@
 
 #define instr and
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE result = op_dest->val & op_src->val;
 	OPERAND_W(op_dest, result);
 
-        update_eflags_pf_zf_sf((DATA_TYPE_S)result);
-        cpu.eflags.CF = cpu.eflags.OF = 0;
-
-
-	print_asm_template2();
+	update_eflags(EFLAGS_LOGIC, DATA_BYTE, op_dest->val, op_src->val, result);
 }
 
 make_instr_helper(i2a)
@@ -2,7 +2,7 @@
 
 #define instr sar
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE src = op_src->val;
 	DATA_TYPE_S dest = op_dest->val;
 
@@ -10,9 +10,7 @@ static void do_execute () {
 	dest >>= count;
 	OPERAND_W(op_dest, dest);
 
-	update_eflags_pf_zf_sf(dest);
-
-	print_asm_template2();
+	update_eflags(EFLAGS_PZS, DATA_BYTE, op_dest->val, src, dest);
 }
 
 make_instr_helper(rm_1)
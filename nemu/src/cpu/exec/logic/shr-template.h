@@ -2,16 +2,14 @@
 
 #define instr shr
 
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE src = op_src->val;
 	DATA_TYPE dest = op_dest->val;
 
 	uint8_t count = src & 0x1f;
 	dest >>= count;
 	OPERAND_W(op_dest, dest);
-        update_eflags_pf_zf_sf(dest);
-
-	print_asm_template2();
+	update_eflags(EFLAGS_PZS, DATA_BYTE, op_dest->val, src, dest);
 }
 
 make_instr_helper(rm_1)
@@ -3,7 +3,7 @@
 #define instr shrd
 
 #if DATA_BYTE == 2 || DATA_BYTE == 4
-static void do_execute () {
+static void do_execute(Operands *ops) {
 	DATA_TYPE in = op_dest->val;
 	DATA_TYPE out = op_src2->val;
 
@@ -17,14 +17,12 @@ static void do_execute () {
 	}
 
 	OPERAND_W(op_src2, out);
-
-	print_asm("shrd" str(SUFFIX) " %s,%s,%s", op_src->str, op_dest->str, op_src2->str);
 }
 
 make_helper(concat(shrdi_, SUFFIX)) {
-	int len = concat(decode_si_rm2r_, SUFFIX) (eip + 1);  /* use decode_si_rm2r to read 1 byte immediate */
+	int len = concat(decode_si_rm2r_, SUFFIX)(eip + 1, ops);  /* use decode_si_rm2r to read 1 byte immediate */
 	op_dest->val = REG(op_dest->reg);
-	do_execute();
+	do_execute(ops);
 	return len + 1;
 }
 #endif
@@ -2,24 +2,54 @@
 #include "cpu/decode/modrm.h"
 
 make_helper(nop) {
-	print_asm("nop");
 	return 1;
 }
 
 make_helper(int3) {
 	void do_int3();
 	do_int3();
-	print_asm("int3");
 
 	return 1;
 }
 
+make_helper(cld) {
+	cpu.eflags.DF = 0;
+	return 1;
+}
+
+make_helper(std) {
+	cpu.eflags.DF = 1;
+	return 1;
+}
+
+make_helper(cli) {
+	cpu.eflags.IF = 0;
+	return 1;
+}
+
+make_helper(sti) {
+	cpu.eflags.IF = 1;
+	return 1;
+}
+
+make_helper(leave) {
+	cpu.esp = cpu.ebp;
+	if(ops->is_operand_size_16) {
+		reg_w(R_BP) = mem_read(cpu.esp, 2, R_SS);
+		cpu.esp += 2;
+	}
+	else {
+		cpu.ebp = mem_read(cpu.esp, 4, R_SS);
+		cpu.esp += 4;
+	}
+	return 1;
+}
+
 make_helper(lea) {
 	ModR_M m;
 	m.val = instr_fetch(eip + 1, 1);
-	int len = load_addr(eip + 1, &m, op_src);
+	int len = load_addr(eip + 1, &m, op_src, ops->is_address_size_16);
 	reg_l(m.reg) = op_src->addr;
 
-	print_asm("leal %s,%%%s", op_src->str, regsl[m.reg]);
 	return 1 + len;
 }
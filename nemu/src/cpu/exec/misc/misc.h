@@ -3,6 +3,11 @@
 
 make_helper(nop);
 make_helper(int3);
+make_helper(cld);
+make_helper(std);
+make_helper(cli);
+make_helper(sti);
+make_helper(leave);
 make_helper(lea);
 
 #endif
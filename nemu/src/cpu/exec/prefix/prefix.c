@@ -3,8 +3,15 @@
 make_helper(exec);
 
 make_helper(operand_size) {
-	ops_decoded.is_operand_size_16 = true;
-	int instr_len = exec(eip + 1);
-	ops_decoded.is_operand_size_16 = false;
+	ops->is_operand_size_16 = true;
+	int instr_len = exec(eip + 1, ops);
+	ops->is_operand_size_16 = false;
+	return instr_len + 1;
+}
+
+make_helper(address_size) {
+	ops->is_address_size_16 = true;
+	int instr_len = exec(eip + 1, ops);
+	ops->is_address_size_16 = false;
 	return instr_len + 1;
 }
@@ -2,5 +2,6 @@
 #define __PREFIX_H__
 
 make_helper(operand_size);
+make_helper(address_size);
 
 #endif
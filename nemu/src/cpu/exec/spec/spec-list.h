@@ -0,0 +1,31 @@
+/* The instructions with specialized handlers. Each line reads
+ *
+ *   SPEC(instr, form, size, op)      opcode
+ *
+ * `form' is r2rm (r/m = r/m op r) or rm2r (r = r op r/m), `size' is b
+ * or v, and `op' selects RESULT_op(), FLAGS_op() and READ_DEST_op in
+ * spec.c. It is stamped out for every operand size and for a register
+ * and a memory r/m by spec-template.h, and `spec_instr_form_size' picks
+ * one of them.
+ */
+
+SPEC(or, r2rm, b, OR)		/* 0x08 */
+SPEC(or, r2rm, v, OR)		/* 0x09 */
+SPEC(or, rm2r, b, OR)		/* 0x0a */
+SPEC(or, rm2r, v, OR)		/* 0x0b */
+SPEC(and, r2rm, b, AND)		/* 0x20 */
+SPEC(and, r2rm, v, AND)		/* 0x21 */
+SPEC(and, rm2r, b, AND)		/* 0x22 */
+SPEC(and, rm2r, v, AND)		/* 0x23 */
+SPEC(sub, r2rm, b, SUB)		/* 0x28 */
+SPEC(sub, r2rm, v, SUB)		/* 0x29 */
+SPEC(sub, rm2r, b, SUB)		/* 0x2a */
+SPEC(sub, rm2r, v, SUB)		/* 0x2b */
+SPEC(xor, r2rm, b, XOR)		/* 0x30 */
+SPEC(xor, r2rm, v, XOR)		/* 0x31 */
+SPEC(xor, rm2r, b, XOR)		/* 0x32 */
+SPEC(xor, rm2r, v, XOR)		/* 0x33 */
+SPEC(mov, r2rm, b, MOV)		/* 0x88 */
+SPEC(mov, r2rm, v, MOV)		/* 0x89 */
+SPEC(mov, rm2r, b, MOV)		/* 0x8a */
+SPEC(mov, rm2r, v, MOV)		/* 0x8b */
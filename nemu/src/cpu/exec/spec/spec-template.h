@@ -0,0 +1,110 @@
+#include "cpu/exec/template-start.h"
+
+#include "cpu/decode/modrm.h"
+
+/* The handlers of one operand size. `_r' is for a register r/m and `_m'
+ * for a memory r/m, the decoding is done right in the handler.
+ *
+ * While the decode cache fills an entry, `_fill' records the `_r' or
+ * `_m' handler, which a hit calls directly. It also decodes through the
+ * generic decoder and records the execute function of the form,
+ * `do_spec_*', for the blocks and the translator reading the operands. */
+
+#define SPEC_NAME(instr, form, rm) concat5(spec_, instr, _, form, concat3(_, SUFFIX, rm))
+#define SPEC_DO_NAME(instr, form, rm) concat(do_, SPEC_NAME(instr, form, rm))
+
+#define SPEC_FILL(instr, form, do_r, do_m) \
+	static make_helper(SPEC_NAME(instr, form, _fill)) { \
+		ModR_M m; \
+		m.val = instr_fetch(eip + 1, 1); \
+		dcache_record_helper(eip, (m.mod == 3 ? SPEC_NAME(instr, form, _r) : SPEC_NAME(instr, form, _m))); \
+		return idex(eip, ops, concat4(decode_, form, _, SUFFIX), (m.mod == 3 ? do_r : do_m)); \
+	}
+
+#define SPEC_r2rm(instr, op) \
+	static make_helper(SPEC_NAME(instr, r2rm, _r)) { \
+		ModR_M m; \
+		m.val = instr_fetch(eip + 1, 1); \
+		DATA_TYPE dest = REG(m.R_M), src = REG(m.reg); \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		REG(m.R_M) = result; \
+		concat(FLAGS_, op) (dest, src, result); \
+		return 2; \
+	} \
+	static make_helper(SPEC_NAME(instr, r2rm, _m)) { \
+		ModR_M m; \
+		Operand rm; \
+		m.val = instr_fetch(eip + 1, 1); \
+		int len = load_addr(eip + 1, &m, &rm, ops->is_address_size_16); \
+		DATA_TYPE dest = (concat(READ_DEST_, op) ? MEM_R(rm.addr, rm.sreg) : 0), src = REG(m.reg); \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		MEM_W(rm.addr, result, rm.sreg); \
+		concat(FLAGS_, op) (dest, src, result); \
+		return 1 + len; \
+	} \
+	static void SPEC_DO_NAME(instr, r2rm, _r) (Operands *ops) { \
+		DATA_TYPE dest = op_dest->val, src = op_src->val; \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		REG(op_dest->reg) = result; \
+		concat(FLAGS_, op) (dest, src, result); \
+	} \
+	static void SPEC_DO_NAME(instr, r2rm, _m) (Operands *ops) { \
+		DATA_TYPE dest = op_dest->val, src = op_src->val; \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		MEM_W(op_dest->addr, result, op_dest->sreg); \
+		concat(FLAGS_, op) (dest, src, result); \
+	} \
+	SPEC_FILL(instr, r2rm, SPEC_DO_NAME(instr, r2rm, _r), SPEC_DO_NAME(instr, r2rm, _m))
+
+#define SPEC_rm2r(instr, op) \
+	static make_helper(SPEC_NAME(instr, rm2r, _r)) { \
+		ModR_M m; \
+		m.val = instr_fetch(eip + 1, 1); \
+		DATA_TYPE dest = REG(m.reg), src = REG(m.R_M); \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		REG(m.reg) = result; \
+		concat(FLAGS_, op) (dest, src, result); \
+		return 2; \
+	} \
+	static make_helper(SPEC_NAME(instr, rm2r, _m)) { \
+		ModR_M m; \
+		Operand rm; \
+		m.val = instr_fetch(eip + 1, 1); \
+		int len = load_addr(eip + 1, &m, &rm, ops->is_address_size_16); \
+		DATA_TYPE dest = REG(m.reg), src = MEM_R(rm.addr, rm.sreg); \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		REG(m.reg) = result; \
+		concat(FLAGS_, op) (dest, src, result); \
+		return 1 + len; \
+	} \
+	/* the destination is a register for both forms of r/m */ \
+	static void SPEC_DO_NAME(instr, rm2r, _r) (Operands *ops) { \
+		DATA_TYPE dest = op_dest->val, src = op_src->val; \
+		DATA_TYPE result = concat(RESULT_, op) (dest, src); \
+		REG(op_dest->reg) = result; \
+		concat(FLAGS_, op) (dest, src, result); \
+	} \
+	SPEC_FILL(instr, rm2r, SPEC_DO_NAME(instr, rm2r, _r), SPEC_DO_NAME(instr, rm2r, _r))
+
+#if DATA_BYTE == 1
+#define SPEC_b(instr, form, op) concat(SPEC_, form) (instr, op)
+#define SPEC_v(instr, form, op)
+#else
+#define SPEC_b(instr, form, op)
+#define SPEC_v(instr, form, op) concat(SPEC_, form) (instr, op)
+#endif
+
+#define SPEC(instr, form, size, op) concat(SPEC_, size) (instr, form, op)
+
+#include "spec-list.h"
+
+#undef SPEC
+#undef SPEC_b
+#undef SPEC_v
+#undef SPEC_r2rm
+#undef SPEC_rm2r
+#undef SPEC_FILL
+#undef SPEC_DO_NAME
+#undef SPEC_NAME
+
+#include "cpu/exec/template-end.h"
@@ -0,0 +1,71 @@
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+#include "../all-instr.h"
+
+/* Handlers specialized for the operand size and the ModR/M form, stamped
+ * out from the description in spec-list.h. They do not go through
+ * make_helper_v(), read_ModR_M() or the Operand structures.
+ */
+
+#define RESULT_OR(dest, src) ((dest) | (src))
+#define RESULT_AND(dest, src) ((dest) & (src))
+#define RESULT_SUB(dest, src) ((dest) - (src))
+#define RESULT_XOR(dest, src) ((dest) ^ (src))
+#define RESULT_MOV(dest, src) ((void)(dest), (src))
+
+#define FLAGS_OR(dest, src, result) update_eflags(EFLAGS_LOGIC, DATA_BYTE, dest, src, result)
+#define FLAGS_AND(dest, src, result) update_eflags(EFLAGS_LOGIC, DATA_BYTE, dest, src, result)
+#define FLAGS_SUB(dest, src, result) update_eflags(EFLAGS_SUB, DATA_BYTE, dest, src, result)
+#define FLAGS_XOR(dest, src, result) update_eflags(EFLAGS_LOGIC, DATA_BYTE, dest, src, result)
+#define FLAGS_MOV(dest, src, result)
+
+/* whether a memory destination is read before it is written */
+#define READ_DEST_OR 1
+#define READ_DEST_AND 1
+#define READ_DEST_SUB 1
+#define READ_DEST_XOR 1
+#define READ_DEST_MOV 0
+
+#define DATA_BYTE 1
+#include "spec-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 2
+#include "spec-template.h"
+#undef DATA_BYTE
+
+#define DATA_BYTE 4
+#include "spec-template.h"
+#undef DATA_BYTE
+
+/* Pick the handler by the operand size and the mod field, or the `_fill'
+ * handler of the size while the decode cache fills an entry. */
+
+typedef int (*helper_fun)(swaddr_t, Operands *);
+
+#define SPEC_b(instr, form) \
+	make_helper(concat4(spec_, instr, _, form##_b)) { \
+		if(dcache_fill_entry) { return concat4(spec_, instr, _, form##_b_fill) (eip, ops); } \
+		ModR_M m; \
+		m.val = instr_fetch(eip + 1, 1); \
+		return (m.mod == 3 ? concat4(spec_, instr, _, form##_b_r) : concat4(spec_, instr, _, form##_b_m)) (eip, ops); \
+	}
+
+#define SPEC_v(instr, form) \
+	make_helper(concat4(spec_, instr, _, form##_v)) { \
+		static const helper_fun handler[2][2] = { \
+			{ concat4(spec_, instr, _, form##_l_m), concat4(spec_, instr, _, form##_l_r) }, \
+			{ concat4(spec_, instr, _, form##_w_m), concat4(spec_, instr, _, form##_w_r) } \
+		}; \
+		static const helper_fun fill[2] = { \
+			concat4(spec_, instr, _, form##_l_fill), concat4(spec_, instr, _, form##_w_fill) \
+		}; \
+		if(dcache_fill_entry) { return fill[ops->is_operand_size_16] (eip, ops); } \
+		ModR_M m; \
+		m.val = instr_fetch(eip + 1, 1); \
+		return handler[ops->is_operand_size_16][m.mod == 3] (eip, ops); \
+	}
+
+#define SPEC(instr, form, size, op) concat(SPEC_, size) (instr, form)
+
+#include "spec-list.h"
@@ -0,0 +1,8 @@
+#ifndef __SPEC_H__
+#define __SPEC_H__
+
+#define SPEC(instr, form, size, op) make_helper(concat5(spec_, instr, _, form, _##size));
+#include "spec-list.h"
+#undef SPEC
+
+#endif
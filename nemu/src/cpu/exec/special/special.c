@@ -1,5 +1,6 @@
 #include "cpu/exec/helper.h"
 #include "monitor/monitor.h"
+#include "monitor/disasm.h"
 
 make_helper(inv) {
 	/* invalid opcode */
@@ -12,6 +13,11 @@ make_helper(inv) {
 	printf("invalid opcode(eip = 0x%08x): %02x %02x %02x %02x %02x %02x %02x %02x ...\n\n", 
 			eip, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
 
+	char buf[80];
+	if(disasm(eip, p, 8, buf, sizeof(buf)) != 0) {
+		printf("which is disassembled as `%s'.\n\n", buf);
+	}
+
 	extern char logo [];
 	printf("There are two cases which will trigger this unexpected exception:\n\
 1. The instruction at eip = 0x%08x is not implemented.\n\
@@ -25,7 +31,6 @@ make_helper(inv) {
 }
 
 make_helper(nemu_trap) {
-	print_asm("nemu trap (eax = %d)", cpu.eax);
 
 	switch(cpu.eax) {
 		case 2:
@@ -0,0 +1,18 @@
+#include "cpu/exec/template-start.h"
+
+#define instr cmps
+
+make_helper(concat(cmps_, SUFFIX)) {
+	DATA_TYPE dest = MEM_R(cpu.esi, R_DS);
+	DATA_TYPE src = MEM_R(cpu.edi, R_ES);
+	DATA_TYPE result = dest - src;
+
+	update_eflags(EFLAGS_SUB, DATA_BYTE, dest, src, result);
+
+	cpu.esi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+	cpu.edi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
+
+	return 1;
+}
+
+#include "cpu/exec/template-end.h"
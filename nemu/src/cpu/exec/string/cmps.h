@@ -0,0 +1,8 @@
+#ifndef __CMPS_H__
+#define __CMPS_H__
+
+make_helper(cmps_b);
+
+make_helper(cmps_v);
+
+#endif
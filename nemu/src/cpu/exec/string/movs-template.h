@@ -3,11 +3,10 @@
 #define instr movs
 
 make_helper(concat(movs_, SUFFIX)) {
-	MEM_W(cpu.edi, MEM_R(cpu.esi));
+	MEM_W(cpu.edi, MEM_R(cpu.esi, R_DS), R_ES);
 	cpu.esi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
 	cpu.edi += (cpu.eflags.DF ? -DATA_BYTE : DATA_BYTE);
 
-	print_asm("movs" str(SUFFIX) " %%ds:(%%esi),%%es:(%%edi)");
 	return 1;
 }
 
@@ -1,73 +1,222 @@
 #include "cpu/exec/helper.h"
+#include "device/port-io.h"
 
 make_helper(exec);
 
-make_helper(rep) {
-	int len;
-	int count = 0;
-	if(instr_fetch(eip + 1, 1) == 0xc3) {
-		/* repz ret */
-		exec(eip + 1);
-		len = 0;
+/* String instructions with rep or repnz are run in bulk over plain
+ * memory, one page at a time, with the same final ECX, ESI, EDI and
+ * flags as the element by element execution. ins and outs are run in
+ * bulk if the port has a bulk callback. An element which can not be run
+ * in bulk, such as one crossing a page boundary or touching MMIO
+ * without a bulk callback, goes through exec().
+ */
+
+#define STRING_PAGE (1u << PAGE_WIDTH)
+
+/* The number of `size'-byte elements, at most `n', which the string at
+ * `addr' goes over without leaving the page of `addr'. */
+static inline uint32_t elems_in_page(swaddr_t addr, int size, uint32_t n) {
+	uint32_t off = addr & (STRING_PAGE - 1), k;
+	if(cpu.eflags.DF) { k = (off + size <= STRING_PAGE ? off / size + 1 : 0); }
+	else { k = (STRING_PAGE - off) / size; }
+	return k < n ? k : n;
+}
+
+/* the lowest address of `n' elements starting at `addr' */
+static inline swaddr_t string_low(swaddr_t addr, int size, uint32_t n) {
+	return cpu.eflags.DF ? addr - (n - 1) * size : addr;
+}
+
+static inline void string_advance(uint32_t n, int size, bool has_src) {
+	uint32_t delta = (cpu.eflags.DF ? -(n * size) : n * size);
+	if(has_src) { cpu.esi += delta; }
+	cpu.edi += delta;
+	cpu.ecx -= n;
+}
+
+static uint32_t movs_bulk(int size) {
+	uint32_t n = elems_in_page(cpu.edi, size, elems_in_page(cpu.esi, size, cpu.ecx));
+	if(n == 0) { return 0; }
+
+	uint32_t bytes = n * size;
+	uint8_t *s = swaddr_bulk(string_low(cpu.esi, size, n), bytes, false, R_DS);
+	uint8_t *d = (s == NULL ? NULL : swaddr_bulk(string_low(cpu.edi, size, n), bytes, true, R_ES));
+	if(d == NULL) { return 0; }
+
+	/* Element by element, a copy overlapping in the direction of the
+	 * copy repeats the source pattern, which memmove() does not. The
+	 * host addresses are compared, since DS and ES may differ. */
+	if(cpu.eflags.DF ? (d < s && s < d + bytes) : (s < d && d < s + bytes)) {
+		return 0;
 	}
+
+	memmove(d, s, bytes);
+	string_advance(n, size, true);
+	return n;
+}
+
+static uint32_t stos_bulk(int size) {
+	uint32_t n = elems_in_page(cpu.edi, size, cpu.ecx);
+	if(n == 0) { return 0; }
+
+	uint8_t *d = swaddr_bulk(string_low(cpu.edi, size, n), n * size, true, R_ES);
+	if(d == NULL) { return 0; }
+
+	uint32_t val = cpu.eax, i;
+	if(size == 1) { memset(d, val, n); }
 	else {
-		while(cpu.ecx) {
-			exec(eip + 1);
-			count ++;
-			cpu.ecx --;
-			assert(ops_decoded.opcode == 0xa4	// movsb
-				|| ops_decoded.opcode == 0xa5	// movsw
-				|| ops_decoded.opcode == 0xaa	// stosb
-				|| ops_decoded.opcode == 0xab	// stosw
-				|| ops_decoded.opcode == 0xa6	// cmpsb
-				|| ops_decoded.opcode == 0xa7	// cmpsw
-				|| ops_decoded.opcode == 0xae	// scasb
-				|| ops_decoded.opcode == 0xaf	// scasw
-				);
-
-			/* TODO: Jump out of the while loop if necessary. */
-			/*if((ops_decoded.opcode == 0xa6	// cmpsb
-						|| ops_decoded.opcode == 0xa7	// cmpsw
-			   ) && !cpu.eflags.ZF) {
-				break;
-			}*/
+		for(i = 0; i < n; i ++, d += size) { memcpy(d, &val, size); }
+	}
+	string_advance(n, size, false);
+	return n;
+}
 
-		}
-		len = 1;
+/* the `i'-th element, in the order of the string, of `n' elements at `p' */
+static inline uint32_t string_elem(const uint8_t *p, uint32_t i, uint32_t n, int size) {
+	uint32_t val = 0;
+	memcpy(&val, p + (cpu.eflags.DF ? n - 1 - i : i) * size, size);
+	return val;
+}
+
+/* Compare `n' elements of the string at `s2' with those at `s1', or
+ * with `val' if `s1' is NULL. Return the number of elements up to and
+ * including the first one ending the repetition, or `n' if none does.
+ * memchr() and memcmp() cover the common strlen() and memcmp() loops. */
+static uint32_t string_scan(const uint8_t *s1, const uint8_t *s2, uint32_t val,
+		uint32_t n, int size, bool stop_if_equal) {
+	if(s1 == NULL && size == 1 && stop_if_equal && !cpu.eflags.DF) {
+		const uint8_t *q = memchr(s2, val, n);
+		return q == NULL ? n : q - s2 + 1;
 	}
+	if(s1 != NULL && !stop_if_equal && memcmp(s1, s2, n * size) == 0) { return n; }
 
-#ifdef DEBUG
-	char temp[80];
-	sprintf(temp, "rep %s", assembly);
-	sprintf(assembly, "%s[cnt = %d]", temp, count);
-#endif
-	
-	return len + 1;
+	uint32_t i;
+	for(i = 0; i < n; i ++) {
+		uint32_t dest = (s1 == NULL ? val : string_elem(s1, i, n, size));
+		if((dest == string_elem(s2, i, n, size)) == stop_if_equal) { return i + 1; }
+	}
+	return n;
 }
 
-make_helper(repnz) {
-	int count = 0;
+/* cmps and scas, `*stop' is set if the repetition ends */
+static uint32_t cmps_scas_bulk(bool is_cmps, int size, bool stop_if_equal, bool *stop) {
+	uint32_t n = elems_in_page(cpu.edi, size, cpu.ecx);
+	if(is_cmps) { n = elems_in_page(cpu.esi, size, n); }
+	if(n == 0) { return 0; }
+
+	uint32_t bytes = n * size;
+	const uint8_t *s1 = NULL, *s2;
+	if(is_cmps) {
+		s1 = swaddr_bulk(string_low(cpu.esi, size, n), bytes, false, R_DS);
+		if(s1 == NULL) { return 0; }
+	}
+	s2 = swaddr_bulk(string_low(cpu.edi, size, n), bytes, false, R_ES);
+	if(s2 == NULL) { return 0; }
+
+	uint32_t mask = (~0u >> ((4 - size) << 3));
+	uint32_t val = cpu.eax & mask;
+	uint32_t m = string_scan(s1, s2, val, n, size, stop_if_equal);
+
+	/* the flags are those of the last comparison */
+	uint32_t dest = (is_cmps ? string_elem(s1, m - 1, n, size) : val);
+	uint32_t src = string_elem(s2, m - 1, n, size);
+	update_eflags(EFLAGS_SUB, size, dest, src, (dest - src) & mask);
+	*stop = ((dest == src) == stop_if_equal);
+
+	string_advance(m, size, is_cmps);
+	return m;
+}
+
+/* ins and outs, only upwards since the port moves the elements in order */
+static uint32_t ins_outs_bulk(bool is_ins, int size) {
+	if(cpu.eflags.DF) { return 0; }
+	swaddr_t addr = (is_ins ? cpu.edi : cpu.esi);
+	uint32_t n = elems_in_page(addr, size, cpu.ecx);
+	if(n == 0) { return 0; }
+
+	void *p = swaddr_bulk(addr, n * size, is_ins, is_ins ? R_ES : R_DS);
+	if(p == NULL) { return 0; }
+	n = pio_bulk(reg_w(R_DX), size, p, n, !is_ins);
+
+	if(is_ins) { cpu.edi += n * size; }
+	else { cpu.esi += n * size; }
+	cpu.ecx -= n;
+	return n;
+}
+
+/* Run as many elements as possible in bulk, return the number of them. */
+static inline uint32_t rep_bulk(uint8_t opcode, int size, bool is_repnz, bool *stop) {
+	switch(opcode) {
+		case 0xa4: case 0xa5: return movs_bulk(size);
+		case 0xaa: case 0xab: return stos_bulk(size);
+		case 0xa6: case 0xa7: return cmps_scas_bulk(true, size, is_repnz, stop);
+		case 0xae: case 0xaf: return cmps_scas_bulk(false, size, is_repnz, stop);
+		case 0x6c: case 0x6d: return ins_outs_bulk(true, size);
+		case 0x6e: case 0x6f: return ins_outs_bulk(false, size);
+		default: return 0;
+	}
+}
+
+static inline bool is_cmps_scas(uint8_t opcode) {
+	return opcode == 0xa6 || opcode == 0xa7 || opcode == 0xae || opcode == 0xaf;
+}
+
+/* Repeat the string instruction at `eip' and return its length. rep
+ * ends a repetition of cmps or scas on ZF = 0, and repnz on ZF = 1. */
+static int rep_string(swaddr_t eip, Operands *ops, bool is_repnz) {
+	/* the operand-size prefix may come before or after rep */
+	bool is_operand_size_16 = ops->is_operand_size_16;
+	uint8_t opcode = instr_fetch(eip, 1);
+	int len = 1;
+	if(opcode == 0x66) {
+		is_operand_size_16 = true;
+		opcode = instr_fetch(eip + 1, 1);
+		len = 2;
+	}
+	int size = (opcode & 0x1 ? (is_operand_size_16 ? 2 : 4) : 1);
+
 	while(cpu.ecx) {
-		exec(eip + 1);
-		count ++;
+		bool stop = false;
+		if(rep_bulk(opcode, size, is_repnz, &stop) != 0) {
+			if(stop) { break; }
+			continue;
+		}
+
+		exec(eip, ops);
 		cpu.ecx --;
-		assert(ops_decoded.opcode == 0xa6	// cmpsb
-				|| ops_decoded.opcode == 0xa7	// cmpsw
-				|| ops_decoded.opcode == 0xae	// scasb
-				|| ops_decoded.opcode == 0xaf	// scasw
-			  );
-
-		if(cpu.eflags.ZF) {
-			break;
+		assert(ops->opcode == 0xa4	// movsb
+			|| ops->opcode == 0xa5	// movsw
+			|| ops->opcode == 0xaa	// stosb
+			|| ops->opcode == 0xab	// stosw
+			|| ops->opcode == 0xa6	// cmpsb
+			|| ops->opcode == 0xa7	// cmpsw
+			|| ops->opcode == 0xae	// scasb
+			|| ops->opcode == 0xaf	// scasw
+			|| ops->opcode == 0x6c	// insb
+			|| ops->opcode == 0x6d	// insw
+			|| ops->opcode == 0x6e	// outsb
+			|| ops->opcode == 0x6f	// outsw
+			);
+
+		if(is_cmps_scas(opcode)) {
+			eflags_sync();
+			if(cpu.eflags.ZF == is_repnz) { break; }
 		}
+	}
 
+	return len;
+}
+
+make_helper(rep) {
+	if(instr_fetch(eip + 1, 1) == 0xc3) {
+		/* repz ret */
+		exec(eip + 1, ops);
+		return 1;
 	}
 
-#ifdef DEBUG
-	char temp[80];
-	sprintf(temp, "repnz %s", assembly);
-	sprintf(assembly, "%s[cnt = %d]", temp, count);
-#endif
+	return 1 + rep_string(eip + 1, ops, false);
+}
 
-	return 1 + 1;
+make_helper(repnz) {
+	return 1 + rep_string(eip + 1, ops, true);
 }
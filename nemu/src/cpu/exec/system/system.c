@@ -0,0 +1,157 @@
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+#include "cpu/decode/decode-cache.h"
+#include "cpu/intr.h"
+
+make_helper(inv);
+
+/* The cached translations and the code cached by virtual address are
+ * dropped whenever the mapping may change. */
+static void flush_mapping() {
+	tlb_flush();
+#ifdef USE_DECODE_CACHE
+	dcache_flush();
+#endif
+}
+
+/* mov r32 -> cr, the mod field is ignored */
+make_helper(mov_r2cr) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	switch(m.reg) {
+		case 0: cpu.cr0.val = reg_l(m.R_M); break;
+		case 3: cpu.cr3.val = reg_l(m.R_M); break;
+		default: return inv(eip, ops);
+	}
+	flush_mapping();
+
+	return 2;
+}
+
+make_helper(mov_cr2r) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	switch(m.reg) {
+		case 0: reg_l(m.R_M) = cpu.cr0.val; break;
+		case 3: reg_l(m.R_M) = cpu.cr3.val; break;
+		default: return inv(eip, ops);
+	}
+
+	return 2;
+}
+
+/* The whole TLB is flushed, which is cheap with the generation tags. */
+make_helper(invlpg) {
+	ModR_M m;
+	Operand rm;
+	m.val = instr_fetch(eip + 1, 1);
+	int len = load_addr(eip + 1, &m, &rm, ops->is_address_size_16);
+	flush_mapping();
+
+	return 1 + len;
+}
+
+/* lgdt and lidt m16&32, with a 16-bit operand size only 24 bits of the
+ * base are loaded */
+static int load_dtr(swaddr_t eip, Operands *ops, uint16_t *limit, uint32_t *base) {
+	ModR_M m;
+	Operand rm;
+	m.val = instr_fetch(eip + 1, 1);
+	if(m.mod == 3) { return inv(eip, ops); }
+	int len = load_addr(eip + 1, &m, &rm, ops->is_address_size_16);
+	*limit = mem_read(rm.addr, 2, rm.sreg);
+	*base = mem_read(rm.addr + 2, 4, rm.sreg);
+	if(ops->is_operand_size_16) { *base &= 0xffffff; }
+
+	return 1 + len;
+}
+
+make_helper(lgdt) {
+	return load_dtr(eip, ops, &cpu.gdtr.limit, &cpu.gdtr.base);
+}
+
+make_helper(lidt) {
+	return load_dtr(eip, ops, &cpu.idtr.limit, &cpu.idtr.base);
+}
+
+/* The length of the instruction whose opcode at `eip' is followed by
+ * `len' bytes, counting the prefixes before the opcode. The caller adds
+ * it to cpu.eip, so a helper jumping to `addr' sets cpu.eip to `addr'
+ * minus it. */
+static inline int full_len(swaddr_t eip, int len) {
+	return eip + len - cpu.eip;
+}
+
+/* int imm8 */
+make_helper(int_i) {
+	uint8_t NO = instr_fetch(eip + 1, 1);
+	int len = full_len(eip, 2);
+	raise_intr(NO, cpu.eip + len);
+	cpu.eip -= len;
+
+	return 2;
+}
+
+static inline uint32_t pop_l() {
+	uint32_t val = mem_read(cpu.esp, 4, R_SS);
+	cpu.esp += 4;
+	return val;
+}
+
+/* iret to the same privilege level */
+make_helper(iret) {
+	if(ops->is_operand_size_16) { return inv(eip, ops); }
+	int len = full_len(eip, 1);
+	swaddr_t ret_addr = pop_l();
+	uint16_t selector = pop_l();
+	cpu.eflags.val = pop_l();
+	cpu.lazy_eflags.op = EFLAGS_NONE;
+	load_sreg(R_CS, selector);
+	cpu.eip = ret_addr - len;
+
+	return 1;
+}
+
+/* mov r/m16 -> sreg, cs can not be loaded this way */
+make_helper(mov_rm2sreg) {
+	ModR_M m;
+	Operand rm, reg;
+	m.val = instr_fetch(eip + 1, 1);
+	if(m.reg >= NR_SREG || m.reg == R_CS) { return inv(eip, ops); }
+	rm.size = 2;
+	int len = read_ModR_M(eip + 1, &rm, &reg, ops->is_address_size_16);
+	load_sreg(m.reg, rm.val);
+
+	return 1 + len;
+}
+
+/* mov sreg -> r/m16, the selector is zero-extended to a 32-bit register */
+make_helper(mov_sreg2rm) {
+	ModR_M m;
+	Operand rm;
+	m.val = instr_fetch(eip + 1, 1);
+	if(m.reg >= NR_SREG) { return inv(eip, ops); }
+	uint16_t selector = cpu.sreg[m.reg].selector;
+	if(m.mod == 3) {
+		if(ops->is_operand_size_16) { reg_w(m.R_M) = selector; }
+		else { reg_l(m.R_M) = selector; }
+		return 2;
+	}
+	int len = load_addr(eip + 1, &m, &rm, ops->is_address_size_16);
+	mem_write(rm.addr, 2, selector, rm.sreg);
+
+	return 1 + len;
+}
+
+/* ljmp ptr16:32 and ptr16:16 */
+make_helper(ljmp) {
+	int size = (ops->is_operand_size_16 ? 2 : 4);
+	swaddr_t offset = instr_fetch(eip + 1, size);
+	uint16_t selector = instr_fetch(eip + 1 + size, 2);
+	if(size == 2) { offset &= 0xffff; }
+	int len = full_len(eip, 3 + size);
+	load_sreg(R_CS, selector);
+	cpu.eip = offset - len;
+
+	return 3 + size;
+}
@@ -0,0 +1,204 @@
+#include "cpu/block.h"
+#include "cpu/exec/helper.h"
+#include "cpu/decode/modrm.h"
+
+#include <inttypes.h>
+
+/* Superinstructions. When a basic block is built, some pairs of
+ * instructions GCC emits together are marked, and each marked pair is
+ * then run by one fused handler in block_exec().
+ */
+
+#ifdef DEBUG
+void trace_instr(swaddr_t, int);
+#define TRACE(eip, len) trace_instr(eip, len)
+#else
+#define TRACE(eip, len) ((void)(eip))
+#endif
+
+static uint64_t fusion_count[NR_FUSION];
+
+static const char *fusion_name[NR_FUSION] = {
+	[FUSE_CMP_JCC] = "cmp/test + jcc",
+	[FUSE_PUSH_MOV] = "push %ebp + mov %esp,%ebp",
+	[FUSE_LEAVE_RET] = "leave + ret",
+	[FUSE_MOV_ADD] = "mov + add",
+};
+
+/* The decodings are only trusted for single decode-execute instructions
+ * without prefixes. */
+static bool is_plain(const BInstr *bi, swaddr_t eip) {
+	return bi->execute != NULL &&
+		instr_fetch(eip, 1) == (bi->ops.opcode > 0xff ? 0x0f : bi->ops.opcode);
+}
+
+/* A one-byte instruction without prefixes. */
+static inline bool is_bare(const BInstr *bi, swaddr_t eip, uint8_t opcode) {
+	return bi->len == 1 && instr_fetch(eip, 1) == opcode;
+}
+
+/* the opcode extension in the ModR/M byte of a group instruction */
+static inline int group_opcode(swaddr_t eip) {
+	ModR_M m;
+	m.val = instr_fetch(eip + 1, 1);
+	return m.opcode;
+}
+
+static bool is_cmp_test(const BInstr *bi, swaddr_t eip) {
+	switch(bi->ops.opcode) {
+		case 0x38 ... 0x3d:
+		case 0x84: case 0x85: case 0xa8: case 0xa9:
+			return true;
+		case 0x80: case 0x81: case 0x83:
+			return group_opcode(eip) == 7;
+		case 0xf6: case 0xf7:
+			return group_opcode(eip) == 0;
+		default:
+			return false;
+	}
+}
+
+static inline bool is_jcc(const BInstr *bi) {
+	uint32_t opcode = bi->ops.opcode;
+	return (opcode >= 0x70 && opcode <= 0x7f) || (opcode >= 0x180 && opcode <= 0x18f);
+}
+
+/* A register or immediate operand of 32 bits. */
+static inline bool is_simple_l(const Operand *op) {
+	return (op->type == OP_TYPE_REG || op->type == OP_TYPE_IMM) && op->size == 4;
+}
+
+static inline uint32_t simple_val(const Operand *op) {
+	return op->type == OP_TYPE_REG ? reg_l(op->reg) : op->val;
+}
+
+/* mov to a register, then add a register or an immediate to it */
+static bool is_mov_add(const BInstr *bi, const BInstr *next, swaddr_t next_eip) {
+	const Operands *mov = &bi->ops, *add = &next->ops;
+	switch(mov->opcode) {
+		case 0x89: case 0x8b: case 0xb8 ... 0xbf: break;
+		default: return false;
+	}
+	switch(add->opcode) {
+		case 0x01: case 0x03: case 0x05: break;
+		case 0x81: case 0x83:
+			if(group_opcode(next_eip) != 0) { return false; }
+			break;
+		default: return false;
+	}
+	return mov->dest.type == OP_TYPE_REG && is_simple_l(&mov->dest) && is_simple_l(&mov->src) &&
+		add->dest.type == OP_TYPE_REG && is_simple_l(&add->dest) && is_simple_l(&add->src) &&
+		add->dest.reg == mov->dest.reg;
+}
+
+static int fusion_kind(const BInstr *bi, swaddr_t eip, const BInstr *next, swaddr_t next_eip) {
+	/* neither leave nor ret has operands to decode */
+	if(is_bare(bi, eip, 0xc9) && is_bare(next, next_eip, 0xc3)) { return FUSE_LEAVE_RET; }
+
+	if(!is_plain(bi, eip) || !is_plain(next, next_eip)) { return FUSE_NONE; }
+
+	if(is_cmp_test(bi, eip) && is_jcc(next)) { return FUSE_CMP_JCC; }
+	if(bi->ops.opcode == 0x55 &&
+			(instr_fetch(next_eip, 2) == 0xe589 || instr_fetch(next_eip, 2) == 0xec8b)) {
+		return FUSE_PUSH_MOV;
+	}
+	if(is_mov_add(bi, next, next_eip)) { return FUSE_MOV_ADD; }
+	return FUSE_NONE;
+}
+
+/* Mark the fusible pairs in a newly built block. */
+void block_fuse(Block *b) {
+	swaddr_t eip = b->eip;
+	int i;
+	for(i = 0; i < b->nr_instr; i ++) {
+		BInstr *bi = &b->instr[i];
+		bi->fusion = FUSE_NONE;
+		if(i + 1 < b->nr_instr) {
+			bi->fusion = fusion_kind(bi, eip, bi + 1, eip + bi->len);
+		}
+		eip += bi->len;
+		if(bi->fusion != FUSE_NONE) {
+			/* the second instruction of a pair starts no other pair */
+			eip += bi[1].len;
+			bi[1].fusion = FUSE_NONE;
+			i ++;
+		}
+	}
+}
+
+/* cmp or test is replayed as usual, and the condition is then evaluated
+ * with eflags_test_cc(), which with LAZY_EFLAGS reads the operands
+ * recorded by cmp or test instead of materializing the flags. */
+static void fuse_cmp_jcc(BInstr *bi) {
+	swaddr_t eip = cpu.eip;
+	dcache_replay(&bi[0].ops, bi[0].execute);
+	cpu.eip += bi[0].len;
+	TRACE(eip, bi[0].len);
+
+	eip = cpu.eip;
+	int cc = bi[1].ops.opcode & 0xf;
+	if(eflags_test_cc(cc)) { cpu.eip += bi[1].ops.src.val; }
+	cpu.eip += bi[1].len;
+	TRACE(eip, bi[1].len);
+}
+
+static void fuse_push_mov(BInstr *bi) {
+	swaddr_t eip = cpu.eip;
+	cpu.esp -= 4;
+	mem_write(cpu.esp, 4, cpu.ebp, R_SS);
+	cpu.eip += 1;
+	TRACE(eip, 1);
+
+	cpu.ebp = cpu.esp;
+	cpu.eip += 2;
+	TRACE(eip + 1, 2);
+}
+
+static void fuse_leave_ret(BInstr *bi) {
+	swaddr_t eip = cpu.eip;
+	cpu.esp = cpu.ebp;
+	cpu.ebp = mem_read(cpu.esp, 4, R_SS);
+	cpu.esp += 4;
+	cpu.eip += 1;
+	TRACE(eip, 1);
+
+	cpu.eip = mem_read(cpu.esp, 4, R_SS);
+	cpu.esp += 4;
+	TRACE(eip + 1, 1);
+}
+
+static void fuse_mov_add(BInstr *bi) {
+	const Operands *mov = &bi[0].ops, *add = &bi[1].ops;
+	int r = mov->dest.reg;
+	swaddr_t eip = cpu.eip;
+	reg_l(r) = simple_val(&mov->src);
+	cpu.eip += bi[0].len;
+	TRACE(eip, bi[0].len);
+
+	eip = cpu.eip;
+	uint32_t dest = reg_l(r), src = simple_val(&add->src);
+	reg_l(r) = dest + src;
+	update_eflags(EFLAGS_ADD, 4, dest, src, dest + src);
+	cpu.eip += bi[1].len;
+	TRACE(eip, bi[1].len);
+}
+
+static void (*fused_handler[NR_FUSION]) (BInstr *) = {
+	[FUSE_CMP_JCC] = fuse_cmp_jcc,
+	[FUSE_PUSH_MOV] = fuse_push_mov,
+	[FUSE_LEAVE_RET] = fuse_leave_ret,
+	[FUSE_MOV_ADD] = fuse_mov_add,
+};
+
+/* Run the pair starting at `bi', including updating cpu.eip. */
+void fused_exec(BInstr *bi) {
+	fusion_count[bi->fusion] ++;
+	fused_handler[bi->fusion](bi);
+}
+
+void print_fusion_stats() {
+	int i;
+	for(i = FUSE_NONE + 1; i < NR_FUSION; i ++) {
+		printf("%-28s %12" PRIu64 "\n", fusion_name[i], fusion_count[i]);
+	}
+}
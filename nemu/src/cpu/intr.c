@@ -0,0 +1,38 @@
+#include "nemu.h"
+#include "cpu/intr.h"
+#include "cpu/eflags.h"
+#include "../../../lib-common/x86-inc/mmu.h"
+
+static inline void push_l(uint32_t val) {
+	cpu.esp -= 4;
+	mem_write(cpu.esp, 4, val, R_SS);
+}
+
+/* Enter the handler of interrupt `NO' through the IDT. EFLAGS, CS and
+ * `ret_addr' are pushed, and cpu.eip is set to the handler. Only 32-bit
+ * interrupt and trap gates without a privilege change are supported.
+ */
+void raise_intr(uint8_t NO, swaddr_t ret_addr) {
+	uint32_t offset = NO * sizeof(GateDesc);
+	Assert(cpu.cr0.protect_enable, "interrupt %d in real mode is not supported", NO);
+	Assert(offset + sizeof(GateDesc) - 1 <= cpu.idtr.limit, "interrupt %d is beyond the IDT limit", NO);
+
+	union {
+		GateDesc desc;
+		uint32_t val[2];
+	} g;
+	g.val[0] = lnaddr_read(cpu.idtr.base + offset, 4);
+	g.val[1] = lnaddr_read(cpu.idtr.base + offset + 4, 4);
+	Assert(g.desc.present, "the gate of interrupt %d is not present", NO);
+
+	eflags_sync();
+	push_l(cpu.eflags.val);
+	push_l(cpu.sreg[R_CS].selector);
+	push_l(ret_addr);
+
+	/* an interrupt gate, unlike a trap gate, masks further interrupts */
+	if(g.desc.type == 0xe) { cpu.eflags.IF = 0; }
+	cpu.eflags.TF = 0;
+	load_sreg(R_CS, g.desc.segment);
+	cpu.eip = (g.desc.offset_31_16 << 16) | g.desc.offset_15_0;
+}
@@ -0,0 +1,320 @@
+#include "cpu/jit.h"
+#include "monitor/monitor.h"
+
+#include <stddef.h>
+#include <sys/mman.h>
+
+/* A simple block translator. `rbx' holds &cpu during a translated
+ * block, so guest registers are accessed as [rbx + disp32]. These are
+ * emitted as native code:
+ *  - mov between registers, of an immediate, and 32-bit loads hitting
+ *    the read TLB through a segment of 4 GiB;
+ *  - add, or, and, sub, xor, cmp and test of 32 bits on a register and
+ *    a register or an immediate, with the host computing the flags;
+ *  - jcc, with the host testing the guest's flags.
+ * Every other instruction becomes a call to jit_run_instr(), which
+ * replays it with the interpreter's helpers. Loads test the segment
+ * limit at run time and take the slow path through swaddr_read() when
+ * it is checked, so only a change of the CS base drops the translations
+ * (through the decode cache generation). In DEBUG
+ * builds the native code calls trace_instr() after each instruction.
+ *
+ * Guest registers are not mapped to host registers. Most blocks still
+ * call helpers which read and write CPU_state, so the mapped registers
+ * would have to be written back around every such call.
+ */
+
+make_helper(exec);
+
+#ifdef DEBUG
+void trace_instr(swaddr_t, int);
+#endif
+
+bool jit_enabled = false;
+
+static uint8_t *code_cache;
+static uint8_t *p;	/* emit pointer */
+
+#define GPR_OFFSET(r) (offsetof(CPU_state, gpr) + (r) * sizeof(cpu.gpr[0]))
+#define EIP_OFFSET offsetof(CPU_state, eip)
+#define SREG_BASE_OFFSET(r) (offsetof(CPU_state, sreg) + (r) * sizeof(SegReg) + offsetof(SegReg, base))
+#define SREG_LIMIT_OFFSET(r) (offsetof(CPU_state, sreg) + (r) * sizeof(SegReg) + offsetof(SegReg, check_limit))
+#define EFLAGS_OFFSET offsetof(CPU_state, eflags)
+#define LAZY_OP_OFFSET offsetof(CPU_state, lazy_eflags.op)
+
+/* CF, PF, ZF, SF and OF */
+#define EFLAGS_ARITH 0x8c5
+
+/* the longest code emitted for a single guest instruction, checked in
+ * jit_translate() */
+#define MAX_INSTR_CODE 256
+
+static inline void emit8(uint8_t b) { *p ++ = b; }
+static inline void emit32(uint32_t w) { memcpy(p, &w, 4); p += 4; }
+static inline void emit64(uint64_t q) { memcpy(p, &q, 8); p += 8; }
+
+/* op [rbx + disp32] with `reg' in the ModR/M reg field */
+static inline void emit_rbx_disp(uint8_t opcode, int reg, uint32_t disp) {
+	emit8(opcode);
+	emit8(0x80 | (reg << 3) | 3);
+	emit32(disp);
+}
+
+static inline void emit_call(void *fun) {
+	emit8(0x48); emit8(0xb8); emit64((uintptr_t)fun);	/* mov rax, fun */
+	emit8(0xff); emit8(0xd0);							/* call rax */
+}
+
+/* Run an instruction which is not translated. Return non-zero if the
+ * translated block must be left. */
+static int jit_run_instr(BInstr *bi) {
+	swaddr_t eip = cpu.eip;
+	uint32_t epoch = dcache_epoch;
+	if(bi->helper) {
+		dcache_call(eip, bi->helper);
+	}
+	else if(bi->execute) {
+		dcache_replay(&bi->ops, bi->execute);
+	}
+	else {
+		Operands ops = { .is_operand_size_16 = false, .is_address_size_16 = false };
+		exec(eip, &ops);
+	}
+	cpu.eip += bi->len;
+#ifdef DEBUG
+	trace_instr(eip, bi->len);
+#endif
+	return nemu_state != RUNNING || epoch != dcache_epoch;
+}
+
+/* eax = effective address of a memory operand */
+static void emit_load_addr(const Operand *op) {
+	emit8(0xb8); emit32(op->disp);						/* mov eax, disp */
+	if(op->base != -1) {
+		emit_rbx_disp(0x03, 0, GPR_OFFSET(op->base));	/* add eax, base */
+	}
+	if(op->index != -1) {
+		emit_rbx_disp(0x8b, 1, GPR_OFFSET(op->index));	/* mov ecx, index */
+		emit8(0xc1); emit8(0xe1); emit8(op->scale);		/* shl ecx, scale */
+		emit8(0x01); emit8(0xc8);						/* add eax, ecx */
+	}
+}
+
+/* eax = the 32-bit memory operand, the fast path of mem_read(). The
+ * segment limit is tested when the code runs, since the segment
+ * registers other than CS may be loaded without dropping translations. */
+static void emit_mem_read(const Operand *op) {
+	uint8_t *limit, *miss, *cross, *done;
+	emit_load_addr(op);
+	emit8(0x41); emit8(0x89); emit8(0xc1);				/* mov r9d, eax */
+	emit_rbx_disp(0x80, 7, SREG_LIMIT_OFFSET(op->sreg)); emit8(0);	/* cmp byte [check_limit], 0 */
+	emit8(0x0f); emit8(0x85); limit = p; emit32(0);	/* jne slow */
+	emit_rbx_disp(0x03, 0, SREG_BASE_OFFSET(op->sreg));	/* add eax, segment base */
+	emit8(0x89); emit8(0xc1);							/* mov ecx, eax */
+	emit8(0xc1); emit8(0xe9); emit8(PAGE_WIDTH);		/* shr ecx, PAGE_WIDTH */
+	emit8(0x81); emit8(0xe1); emit32(NR_TLB - 1);		/* and ecx, NR_TLB - 1 */
+	emit8(0x6b); emit8(0xc9); emit8(sizeof(TLBEntry));	/* imul ecx, ecx, sizeof(TLBEntry) */
+	emit8(0x48); emit8(0xba); emit64((uintptr_t)tlb[TLB_READ]);	/* mov rdx, tlb[TLB_READ] */
+	emit8(0x48); emit8(0x01); emit8(0xca);				/* add rdx, rcx */
+	emit8(0x89); emit8(0xc1);							/* mov ecx, eax */
+	emit8(0x81); emit8(0xe1); emit32(~PAGE_OFFSET_MASK);/* and ecx, ~PAGE_OFFSET_MASK */
+	emit8(0x49); emit8(0xb8); emit64((uintptr_t)&tlb_gen);	/* mov r8, &tlb_gen */
+	emit8(0x41); emit8(0x0b); emit8(0x08);				/* or ecx, [r8] */
+	emit8(0x3b); emit8(0x0a);							/* cmp ecx, [rdx] (tag) */
+	emit8(0x0f); emit8(0x85); miss = p; emit32(0);		/* jne slow */
+	emit8(0x89); emit8(0xc1);							/* mov ecx, eax */
+	emit8(0x81); emit8(0xe1); emit32(PAGE_OFFSET_MASK);	/* and ecx, PAGE_OFFSET_MASK */
+	emit8(0x81); emit8(0xf9); emit32(PAGE_OFFSET_MASK + 1 - 4);	/* cmp ecx, PAGE_OFFSET_MASK + 1 - 4 */
+	emit8(0x0f); emit8(0x87); cross = p; emit32(0);		/* ja slow */
+	emit8(0x48); emit8(0x03); emit8(0x42); emit8(offsetof(TLBEntry, addend));	/* add rax, [rdx + addend] */
+	emit8(0x8b); emit8(0x00);							/* mov eax, [rax] */
+	emit8(0xe9); done = p; emit32(0);					/* jmp done */
+	*(uint32_t *)limit = p - (limit + 4);
+	*(uint32_t *)miss = p - (miss + 4);
+	*(uint32_t *)cross = p - (cross + 4);
+	emit8(0x44); emit8(0x89); emit8(0xcf);				/* slow: mov edi, r9d */
+	emit8(0xbe); emit32(4);								/* mov esi, 4 */
+	emit8(0xba); emit32(op->sreg);						/* mov edx, sreg */
+	emit_call(swaddr_read);
+	*(uint32_t *)done = p - (done + 4);
+}
+
+/* ALU operations as the ModR/M reg field of 0x81, and test */
+enum { ALU_ADD, ALU_OR, ALU_ADC, ALU_SBB, ALU_AND, ALU_SUB, ALU_XOR, ALU_CMP, ALU_TEST };
+
+/* The ALU operation of `bi' at `eip', or -1. adc and sbb read CF and are
+ * left to the helpers. */
+static int alu_op(const BInstr *bi, swaddr_t eip) {
+	uint32_t opcode = bi->ops.opcode;
+	int op;
+	switch(opcode) {
+		case 0x00 ... 0x3f:
+			/* r2rm, rm2r and i2a of 32 bits */
+			if((opcode & 0x7) != 1 && (opcode & 0x7) != 3 && (opcode & 0x7) != 5) { return -1; }
+			op = opcode >> 3;
+			break;
+		case 0x81: case 0x83: {
+			ModR_M m;
+			m.val = instr_fetch(eip + 1, 1);
+			op = m.opcode;
+			break;
+		}
+		case 0x85: case 0xa9: return ALU_TEST;
+		default: return -1;
+	}
+	return (op == ALU_ADC || op == ALU_SBB ? -1 : op);
+}
+
+/* The host instruction computes the result and the flags. CF, PF, ZF, SF
+ * and OF are copied to the guest, AF is left alone as by the helpers. */
+static void emit_alu(int op, const Operand *src, const Operand *dest) {
+	emit_rbx_disp(0x8b, 0, GPR_OFFSET(dest->reg));			/* mov eax, dest */
+	if(src->type == OP_TYPE_REG) {
+		if(op == ALU_TEST) { emit_rbx_disp(0x85, 0, GPR_OFFSET(src->reg)); }	/* test src, eax */
+		else { emit_rbx_disp((op << 3) | 0x3, 0, GPR_OFFSET(src->reg)); }	/* op eax, src */
+	}
+	else {
+		if(op == ALU_TEST) { emit8(0xa9); }					/* test eax, imm32 */
+		else { emit8(0x81); emit8(0xc0 | (op << 3)); }		/* op eax, imm32 */
+		emit32(src->val);
+	}
+	emit8(0x9c);											/* pushfq */
+	emit8(0x59);											/* pop rcx */
+	if(op != ALU_CMP && op != ALU_TEST) {
+		emit_rbx_disp(0x89, 0, GPR_OFFSET(dest->reg));		/* mov dest, eax */
+	}
+	emit8(0x81); emit8(0xe1); emit32(EFLAGS_ARITH);			/* and ecx, EFLAGS_ARITH */
+	emit_rbx_disp(0x8b, 2, EFLAGS_OFFSET);					/* mov edx, eflags */
+	emit8(0x81); emit8(0xe2); emit32(~EFLAGS_ARITH);		/* and edx, ~EFLAGS_ARITH */
+	emit8(0x09); emit8(0xca);								/* or edx, ecx */
+	emit_rbx_disp(0x89, 2, EFLAGS_OFFSET);					/* mov eflags, edx */
+	emit_rbx_disp(0xc7, 0, LAZY_OP_OFFSET);					/* the flags are up to date */
+	emit32(EFLAGS_NONE);
+}
+
+/* The guest's flags are loaded to the host, and the host cmovcc of the
+ * same condition picks the next eip. */
+static void emit_jcc(int cc, swaddr_t next, swaddr_t target) {
+#ifdef LAZY_EFLAGS
+	emit_rbx_disp(0x83, 7, LAZY_OP_OFFSET); emit8(EFLAGS_NONE);	/* cmp lazy op, EFLAGS_NONE */
+	emit8(0x74); emit8(12);									/* je synced */
+	emit_call(eflags_materialize);
+#endif
+	emit_rbx_disp(0x8b, 0, EFLAGS_OFFSET);					/* synced: mov eax, eflags */
+	emit8(0x25); emit32(EFLAGS_ARITH);						/* and eax, EFLAGS_ARITH */
+	emit8(0x50);											/* push rax */
+	emit8(0x9d);											/* popfq */
+	emit8(0xb9); emit32(next);								/* mov ecx, next */
+	emit8(0xba); emit32(target);							/* mov edx, target */
+	emit8(0x0f); emit8(0x40 | cc); emit8(0xca);				/* cmovcc ecx, edx */
+	emit_rbx_disp(0x89, 1, EIP_OFFSET);						/* mov eip, ecx */
+}
+
+/* Try to emit native code for `bi' at `eip', return false if it is not
+ * supported. */
+static bool emit_inline(const BInstr *bi, swaddr_t eip) {
+	const Operands *ops = &bi->ops;
+	const Operand *src = &ops->src, *dest = &ops->dest;
+	uint32_t opcode = ops->opcode;
+	int op;
+
+	/* the decodings of instructions with prefixes are not trusted */
+	if(instr_fetch(eip, 1) != (opcode > 0xff ? 0x0f : opcode)) { return false; }
+
+	if((opcode >= 0x70 && opcode <= 0x7f) || (opcode >= 0x180 && opcode <= 0x18f)) {
+		/* jcc only needs its displacement, so it is read here instead
+		 * of relying on the decoding */
+		int32_t rel = (opcode < 0x100 ? (int8_t)instr_fetch(eip + 1, 1) : instr_fetch(eip + 2, 4));
+		emit_jcc(opcode & 0xf, eip + bi->len, eip + bi->len + rel);
+		goto done;
+	}
+
+	if(bi->execute == NULL || dest->type != OP_TYPE_REG || dest->size != 4 ||
+			(src->type == OP_TYPE_MEM && src->addr16)) {
+		return false;
+	}
+
+	if((op = alu_op(bi, eip)) != -1) {
+		if(src->type != OP_TYPE_REG && src->type != OP_TYPE_IMM) { return false; }
+		emit_alu(op, src, dest);
+	}
+	else {
+		switch(opcode) {
+			case 0x89: case 0x8b:	/* mov r/m32 <-> r32 */
+				if(src->type == OP_TYPE_REG) {
+					emit_rbx_disp(0x8b, 0, GPR_OFFSET(src->reg));	/* mov eax, src */
+				}
+				else if(src->type == OP_TYPE_MEM) {
+					emit_mem_read(src);
+				}
+				else { return false; }
+				emit_rbx_disp(0x89, 0, GPR_OFFSET(dest->reg));		/* mov dest, eax */
+				break;
+
+			case 0xb8 ... 0xbf:		/* mov imm32 -> r32 */
+			case 0xc7:
+				if(src->type != OP_TYPE_IMM) { return false; }
+				emit_rbx_disp(0xc7, 0, GPR_OFFSET(dest->reg));		/* mov dest, imm32 */
+				emit32(src->imm);
+				break;
+
+			default: return false;
+		}
+	}
+
+	emit_rbx_disp(0x81, 0, EIP_OFFSET);								/* add eip, len */
+	emit32(bi->len);
+done:
+#ifdef DEBUG
+	emit8(0xbf); emit32(eip);										/* mov edi, eip */
+	emit8(0xbe); emit32(bi->len);									/* mov esi, len */
+	emit_call(trace_instr);
+#endif
+	return true;
+}
+
+static void emit_run_instr(const BInstr *bi, int nr_done) {
+	emit8(0x48); emit8(0xbf); emit64((uintptr_t)bi);	/* mov rdi, bi */
+	emit_call(jit_run_instr);
+	emit8(0x85); emit8(0xc0);							/* test eax, eax */
+	emit8(0x74); emit8(0x07);							/* jz next */
+	emit8(0xb8); emit32(nr_done);						/* mov eax, nr_done */
+	emit8(0x5b);										/* pop rbx */
+	emit8(0xc3);										/* ret */
+}
+
+jit_code_t jit_translate(Block *b) {
+	if(p + (b->nr_instr + 1) * MAX_INSTR_CODE > code_cache + JIT_CACHE_SIZE) {
+		/* code cache is full, start over */
+		block_flush_jit();
+		p = code_cache;
+	}
+
+	uint8_t *code = p;
+	emit8(0x53);										/* push rbx */
+	emit8(0x48); emit8(0xbb); emit64((uintptr_t)&cpu);	/* mov rbx, &cpu */
+
+	swaddr_t eip = b->eip;
+	int i;
+	for(i = 0; i < b->nr_instr; i ++) {
+		uint8_t *start = p;
+		if(!emit_inline(&b->instr[i], eip)) {
+			emit_run_instr(&b->instr[i], i + 1);
+		}
+		Assert(p - start <= MAX_INSTR_CODE, "%d bytes of code emitted for eip = 0x%08x", (int)(p - start), eip);
+		eip += b->instr[i].len;
+	}
+
+	emit8(0xb8); emit32(b->nr_instr);					/* mov eax, nr_instr */
+	emit8(0x5b);										/* pop rbx */
+	emit8(0xc3);										/* ret */
+
+	return (jit_code_t)code;
+}
+
+void init_jit() {
+	code_cache = mmap(NULL, JIT_CACHE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	Assert(code_cache != MAP_FAILED, "Can not allocate the JIT code cache");
+	p = code_cache;
+}
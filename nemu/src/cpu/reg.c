@@ -9,6 +9,7 @@ CPU_state cpu;
 const char *regsl[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
 const char *regsw[] = {"ax", "cx", "dx", "bx", "sp", "bp", "si", "di"};
 const char *regsb[] = {"al", "cl", "dl", "bl", "ah", "ch", "dh", "bh"};
+const char *regss[] = {"es", "cs", "ss", "ds", "fs", "gs"};
 //定义了三个字符串数组，分别表示32位、16位和8位寄存器的名称
 
 void reg_test() {
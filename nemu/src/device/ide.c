@@ -17,6 +17,31 @@ static uint32_t byte_cnt;
 static bool ide_write;
 static FILE *disk_fp;
 
+/* Read `len' bytes from the disk to `addr' page by page, through
+ * hwaddr_bulk() where possible, so that DMA reaches MMIO regions and
+ * invalidates the decode cache like any other store. */
+static void dma_read_disk(hwaddr_t addr, size_t len) {
+	uint8_t buf[PAGE_OFFSET_MASK + 1];
+	int ret;
+	while(len > 0) {
+		size_t n = PAGE_OFFSET_MASK + 1 - (addr & PAGE_OFFSET_MASK);
+		if(n > len) { n = len; }
+		uint8_t *p = hwaddr_bulk(addr, n, true);
+		if(p != NULL) {
+			ret = fread(p, n, 1, disk_fp);
+			assert(ret == 1 || feof(disk_fp));
+		}
+		else {
+			ret = fread(buf, n, 1, disk_fp);
+			assert(ret == 1 || feof(disk_fp));
+			int i;
+			for(i = 0; i < n; i ++) { hwaddr_write(addr + i, 1, buf[i]); }
+		}
+		addr += n;
+		len -= n;
+	}
+}
+
 void ide_io_handler(ioaddr_t addr, size_t len, bool is_write) {
 	assert(byte_cnt <= 512);
 	int ret;
@@ -82,8 +107,37 @@ void ide_io_handler(ioaddr_t addr, size_t len, bool is_write) {
 	}
 }
 
+/* rep insl/outsl on the data port, moving the rest of the sector at most */
+size_t ide_bulk_handler(ioaddr_t addr, size_t len, void *buf, size_t count, bool is_write) {
+	if(addr - IDE_PORT != 0 || len != 4) { return 0; }
+	assert(byte_cnt <= 512);
+	size_t n = (512 - byte_cnt) / 4;
+	if(n > count) { n = count; }
+	if(n == 0) { return 0; }
+
+	size_t ret;
+	if(is_write) {
+		assert(ide_write);
+		ret = fwrite(buf, 4, n, disk_fp);
+		assert(ret == n);
+	}
+	else {
+		assert(!ide_write);
+		ret = fread(buf, 4, n, disk_fp);
+		assert(ret == n || feof(disk_fp));
+	}
+	/* the data register holds the last element, as after single accesses */
+	memcpy(ide_port_base, (uint8_t *)buf + (n - 1) * 4, 4);
+
+	byte_cnt += n * 4;
+	if(byte_cnt == 512) {
+		/* finish */
+		ide_port_base[7] = 0x40;
+	}
+	return n;
+}
+
 void bmr_io_handler(ioaddr_t addr, size_t len, bool is_write) {
-	int ret;
 	if(is_write) {
 		if(addr - BMR_PORT == 0) {
 			if(bmr_base[0] & 0x1) {
@@ -103,8 +157,7 @@ void bmr_io_handler(ioaddr_t addr, size_t len, bool is_write) {
 					disk_idx = sector << 9;
 					fseek(disk_fp, disk_idx, SEEK_SET);
 
-					ret = fread((void *)hwa_to_va(addr), byte_cnt, 1, disk_fp);
-					assert(ret == 1 || feof(disk_fp));
+					dma_read_disk(addr, byte_cnt);
 
 					/* We only implement PRDT of single entry. */
 					assert(hi_entry & 0x80000000);
@@ -125,6 +178,7 @@ void bmr_io_handler(ioaddr_t addr, size_t len, bool is_write) {
 void init_ide() {
 	ide_port_base = add_pio_map(IDE_PORT, 8, ide_io_handler);
 	ide_port_base[7] = 0x40;
+	add_pio_bulk(IDE_PORT, ide_bulk_handler);
 
 	bmr_base = add_pio_map(BMR_PORT, 8, bmr_io_handler);
 	bmr_base[0] = 0;
@@ -13,37 +13,48 @@ typedef struct {
 	hwaddr_t high;
 	uint8_t *mmio_space;
 	mmio_callback_t callback;
+	mmio_callback_t bulk_callback;	/* NULL if not supported */
 } MMIO_t;
 
 static MMIO_t maps[NR_MAP];
 static int nr_map = 0;
 
-/* device interface */
+uint8_t mmio_page[NR_PHYS_PAGE];
+
+/* device interface, the regions are mapped by page */
 void* add_mmio_map(hwaddr_t addr, size_t len, mmio_callback_t callback) {
 	assert(nr_map < NR_MAP);
 	assert(mmio_space_free_index + len <= MMIO_SPACE_MAX);
+	assert((addr & PAGE_OFFSET_MASK) == 0 && (len & PAGE_OFFSET_MASK) == 0);
 
 	uint8_t *space_base = &mmio_space_pool[mmio_space_free_index];
 	maps[nr_map].low = addr;
 	maps[nr_map].high = addr + len - 1;
 	maps[nr_map].mmio_space = space_base;
 	maps[nr_map].callback = callback;
+	maps[nr_map].bulk_callback = NULL;
 	nr_map ++;
+
+	hwaddr_t page;
+	for(page = addr >> PAGE_WIDTH; page < (addr + len) >> PAGE_WIDTH; page ++) {
+		assert(mmio_page[page] == 0);
+		mmio_page[page] = nr_map;
+	}
+
 	mmio_space_free_index += len;
 	return space_base;
 }
 
-/* bus interface */
-int is_mmio(hwaddr_t addr) {
-	int i;
-	for(i = 0; i < nr_map; i ++) {
-		if(addr >= maps[i].low && addr <= maps[i].high) {
-			return i;
-		}
-	}
-	return -1;
+/* Let the region at `addr' be accessed in bulk. `callback' is then
+ * called once for a whole bulk access, before the access. */
+void add_mmio_bulk(hwaddr_t addr, mmio_callback_t callback) {
+	int map_NO = is_mmio(addr);
+	assert(map_NO != -1);
+	maps[map_NO].bulk_callback = callback;
 }
 
+/* bus interface */
+
 uint32_t mmio_read(hwaddr_t addr, size_t len, int map_NO) {
 	assert(len == 1 || len == 2 || len == 4);
 	MMIO_t *map = &maps[map_NO];
@@ -60,3 +71,12 @@ void mmio_write(hwaddr_t addr, size_t len, uint32_t data, int map_NO) {
 	memcpy_with_mask(map->mmio_space + (addr - map->low), &data, len, (void *)&mask);
 	maps[map_NO].callback(addr, len, true);
 }
+
+/* A host pointer to `[addr, addr + len)' within region `map_NO', or
+ * NULL if the region does not support bulk accesses. */
+void *mmio_bulk(hwaddr_t addr, size_t len, bool is_write, int map_NO) {
+	MMIO_t *map = &maps[map_NO];
+	if(map->bulk_callback == NULL || addr + len - 1 > map->high) { return NULL; }
+	map->bulk_callback(addr, len, is_write);
+	return map->mmio_space + (addr - map->low);
+}
@@ -11,18 +11,26 @@ typedef struct {
 	ioaddr_t low;
 	ioaddr_t high;
 	pio_callback_t callback;
+	pio_bulk_callback_t bulk_callback;	/* NULL if not supported */
 } PIO_t;
 
 static PIO_t maps[NR_MAP];
 static int nr_map = 0;
 
+/* the map of every port, 0 for none and N + 1 for map N */
+static uint8_t port_map[PORT_IO_SPACE_MAX];
+
+/* the map covering the whole access, or NULL */
+static inline PIO_t *pio_map(ioaddr_t addr, size_t len) {
+	int n = port_map[addr];
+	if(n == 0 || addr + len - 1 > maps[n - 1].high) { return NULL; }
+	return &maps[n - 1];
+}
+
 static void pio_callback(ioaddr_t addr, size_t len, bool is_write) {
-	int i;
-	for(i = 0; i < nr_map; i ++) {
-		if(addr >= maps[i].low && addr + len - 1 <= maps[i].high) {
-			maps[i].callback(addr, len, is_write);
-			return;
-		}
+	PIO_t *map = pio_map(addr, len);
+	if(map != NULL) {
+		map->callback(addr, len, is_write);
 	}
 }
 
@@ -33,10 +41,22 @@ void* add_pio_map(ioaddr_t addr, size_t len, pio_callback_t callback) {
 	maps[nr_map].low = addr;
 	maps[nr_map].high = addr + len - 1;
 	maps[nr_map].callback = callback;
+	maps[nr_map].bulk_callback = NULL;
 	nr_map ++;
+
+	int i;
+	for(i = addr; i < addr + len; i ++) {
+		assert(port_map[i] == 0);
+		port_map[i] = nr_map;
+	}
 	return pio_space + addr;
 }
 
+void add_pio_bulk(ioaddr_t addr, pio_bulk_callback_t callback) {
+	assert(port_map[addr] != 0);
+	maps[port_map[addr] - 1].bulk_callback = callback;
+}
+
 
 /* CPU interface */
 uint32_t pio_read(ioaddr_t addr, size_t len) {
@@ -54,3 +74,9 @@ void pio_write(ioaddr_t addr, size_t len, uint32_t data) {
 	pio_callback(addr, len, true);
 }
 
+/* for rep ins/outs, return 0 if the port does not support bulk transfers */
+size_t pio_bulk(ioaddr_t addr, size_t len, void *buf, size_t count, bool is_write) {
+	PIO_t *map = pio_map(addr, len);
+	if(map == NULL || map->bulk_callback == NULL) { return 0; }
+	return map->bulk_callback(addr, len, buf, count, is_write);
+}
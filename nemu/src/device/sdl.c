@@ -4,6 +4,7 @@
 
 #include "sdl.h"
 #include "vga.h"
+#include "monitor/monitor.h"
 
 #include <sys/time.h>
 #include <signal.h>
@@ -27,6 +28,7 @@ static void timer_sig_handler(int signum) {
 	timer_intr();
 
 	device_update_flag = true;
+	pending_events |= EVENT_DEVICE;
 	if(jiffy % (TIMER_HZ / VGA_HZ) == 0) {
 		update_screen_flag = true;
 	}
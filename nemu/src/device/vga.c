@@ -47,6 +47,18 @@ void vga_vmem_io_handler(hwaddr_t addr, size_t len, bool is_write) {
 	}
 }
 
+/* string instructions and DMA mark every line they write at once */
+void vga_vmem_bulk_handler(hwaddr_t addr, size_t len, bool is_write) {
+	if(is_write) {
+		int line = (addr - 0xa0000) / CTR_COL;
+		int last = (addr + len - 1 - 0xa0000) / CTR_COL;
+		for(; line <= last && line < CTR_ROW; line ++) {
+			line_dirty[line] = true;
+			vmem_dirty = true;
+		}
+	}
+}
+
 void do_update_screen_graphic_mode() {
 	int i, j;
 	uint8_t (*vmem) [CTR_COL] = vmem_base;
@@ -109,5 +121,6 @@ void init_vga() {
 	vga_dac_port_base = add_pio_map(VGA_DAC_WRITE_INDEX, 2, vga_dac_io_handler);
 	vga_crtc_port_base = add_pio_map(VGA_CRTC_INDEX, 2, vga_crtc_io_handler);
 	vmem_base = add_mmio_map(0xa0000, 0x20000, vga_vmem_io_handler);
+	add_mmio_bulk(0xa0000, vga_vmem_bulk_handler);
 }
 #endif	/* HAS_DEVICE */
@@ -1,6 +1,7 @@
 #include "common.h"
 #include "burst.h"
-#include "misc.h"
+
+#include <inttypes.h>
 
 /* Simulate the (main) behavor of DRAM.
  * Although this will lower the performace of NEMU, it makes
@@ -38,10 +39,24 @@ typedef struct {
 	uint8_t buf[NR_COL];
 	int32_t row_idx;
 	bool valid;
+	bool dirty;
 } RB;
 
 RB rowbufs[NR_RANK][NR_BANK];
 
+/* row buffer statistics of each bank */
+typedef struct {
+	uint64_t hit;		/* the row is already open */
+	uint64_t miss;		/* the row buffer is empty */
+	uint64_t conflict;	/* another row is open and must be closed */
+} RB_stat;
+
+static RB_stat rb_stats[NR_RANK][NR_BANK];
+
+/* Close all rows, dropping what they hold. restart() reads the program
+ * into `hw_mem' directly and then calls this, so that no row opened
+ * before shadows it. Nothing else accesses `hw_mem' directly while
+ * `use_dram' is set. */
 void init_ddr3() {
 	//定义void函数 init_ddr3
 	int i, j;
@@ -51,51 +66,79 @@ void init_ddr3() {
 		}
 	}
 	//执行一个嵌套的循环，作用是初始化 rowbufs 数组中的每个元素的 valid 字段为 false
+	memset(rb_stats, 0, sizeof(rb_stats));
 }
 
-static void ddr3_read(hwaddr_t addr, void *data) {
+/* Open the row containing `addr' and return its row buffer. The row
+ * buffer is write-back: the open row is written back to `dram' only
+ * when it is closed.
+ */
+static RB* ddr3_open(hwaddr_t addr) {
 	Assert(addr < HW_MEM_SIZE, "physical address %x is outside of the physical memory!", addr);
 
 	dram_addr temp;
-	temp.addr = addr & ~BURST_MASK;
+	temp.addr = addr;
 	uint32_t rank = temp.rank;
 	uint32_t bank = temp.bank;
 	uint32_t row = temp.row;
-	uint32_t col = temp.col;
+	RB *rb = &rowbufs[rank][bank];
 
-	if(!(rowbufs[rank][bank].valid && rowbufs[rank][bank].row_idx == row) ) {
-		/* read a row into row buffer */
-		memcpy(rowbufs[rank][bank].buf, dram[rank][bank][row], NR_COL);
-		rowbufs[rank][bank].row_idx = row;
-		rowbufs[rank][bank].valid = true;
+	if(rb->valid && rb->row_idx == row) {
+		rb_stats[rank][bank].hit ++;
+		return rb;
 	}
 
-	/* burst read */
-	memcpy(data, rowbufs[rank][bank].buf + col, BURST_LEN);
+	if(rb->valid) {
+		rb_stats[rank][bank].conflict ++;
+		if(rb->dirty) {
+			memcpy(dram[rank][bank][rb->row_idx], rb->buf, NR_COL);
+		}
+	}
+	else {
+		rb_stats[rank][bank].miss ++;
+	}
+
+	/* read a row into row buffer */
+	memcpy(rb->buf, dram[rank][bank][row], NR_COL);
+	rb->row_idx = row;
+	rb->valid = true;
+	rb->dirty = false;
+	return rb;
 }
 
-static void ddr3_write(hwaddr_t addr, void *data, uint8_t *mask) {
-	Assert(addr < HW_MEM_SIZE, "physical address %x is outside of the physical memory!", addr);
+static void ddr3_read(hwaddr_t addr, void *data) {
+	addr &= ~BURST_MASK;
+	RB *rb = ddr3_open(addr);
 
-	dram_addr temp;
-	temp.addr = addr & ~BURST_MASK;
-	uint32_t rank = temp.rank;
-	uint32_t bank = temp.bank;
-	uint32_t row = temp.row;
-	uint32_t col = temp.col;
+	/* burst read */
+	memcpy(data, rb->buf + (addr & (NR_COL - 1)), BURST_LEN);
+}
 
-	if(!(rowbufs[rank][bank].valid && rowbufs[rank][bank].row_idx == row) ) {
-		/* read a row into row buffer */
-		memcpy(rowbufs[rank][bank].buf, dram[rank][bank][row], NR_COL);
-		rowbufs[rank][bank].row_idx = row;
-		rowbufs[rank][bank].valid = true;
-	}
+/* The data must not cross the row boundary. */
+static void ddr3_write(hwaddr_t addr, size_t len, uint32_t data) {
+	RB *rb = ddr3_open(addr);
+	uint8_t *p = rb->buf + (addr & (NR_COL - 1));
 
-	/* burst write */
-	memcpy_with_mask(rowbufs[rank][bank].buf + col, data, BURST_LEN, mask);
+	switch(len) {
+		case 1: *p = data; break;
+		case 2: unalign_rw(p, 2) = data; break;
+		default: unalign_rw(p, 4) = data; break;
+	}
+	rb->dirty = true;
+}
 
-	/* write back to dram */
-	memcpy(dram[rank][bank][row], rowbufs[rank][bank].buf, NR_COL);
+void print_ddr3_stats() {
+	int i, j;
+	printf("rank bank %12s %12s %12s\n", "hit", "miss", "conflict");
+	for(i = 0; i < NR_RANK; i ++) {
+		for(j = 0; j < NR_BANK; j ++) {
+			RB_stat *s = &rb_stats[i][j];
+			if(s->hit + s->miss + s->conflict != 0) {
+				printf("%4d %4d %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+						i, j, s->hit, s->miss, s->conflict);
+			}
+		}
+	}
 }
 
 uint32_t dram_read(hwaddr_t addr, size_t len) {
@@ -113,18 +156,14 @@ uint32_t dram_read(hwaddr_t addr, size_t len) {
 }
 
 void dram_write(hwaddr_t addr, size_t len, uint32_t data) {
-	uint32_t offset = addr & BURST_MASK;
-	uint8_t temp[2 * BURST_LEN];
-	uint8_t mask[2 * BURST_LEN];
-	memset(mask, 0, 2 * BURST_LEN);
-
-	*(uint32_t *)(temp + offset) = data;
-	memset(mask + offset, 1, len);
-
-	ddr3_write(addr, temp, mask);
-
-	if(offset + len > BURST_LEN) {
-		/* data cross the burst boundary */
-		ddr3_write(addr + BURST_LEN, temp + BURST_LEN, mask + BURST_LEN);
+	if((addr & (NR_COL - 1)) + len <= NR_COL) {
+		ddr3_write(addr, len, data);
+	}
+	else {
+		/* data cross the row boundary */
+		int i;
+		for(i = 0; i < len; i ++) {
+			ddr3_write(addr + i, 1, data >> (i << 3));
+		}
 	}
 }
@@ -1,37 +1,192 @@
 #include "common.h"
+#include "cpu/decode/decode-cache.h"
+
+#ifdef HAS_DEVICE
+#include "device/mmio.h"
+#endif
 
 uint32_t dram_read(hwaddr_t, size_t);
 void dram_write(hwaddr_t, size_t, uint32_t);
 
+bool use_dram = false;
+
+uint8_t page_flag[NR_PAGE];
+
+void mem_watch_write(hwaddr_t, size_t, uint32_t);
+
+/* The flat backend: plain loads and stores to `hw_mem'. */
+static inline uint32_t flat_read(hwaddr_t addr, size_t len) {
+	Assert(addr <= HW_MEM_SIZE - len,
+			"physical address %x is outside of the physical memory!", addr);
+	uint8_t *p = hwa_to_va(addr);
+	switch(len) {
+		case 1: return *p;
+		case 2: return unalign_rw(p, 2);
+		default: return unalign_rw(p, 4);
+	}
+}
+
+static inline void flat_write(hwaddr_t addr, size_t len, uint32_t data) {
+	Assert(addr <= HW_MEM_SIZE - len,
+			"physical address %x is outside of the physical memory!", addr);
+	uint8_t *p = hwa_to_va(addr);
+	switch(len) {
+		case 1: *p = data; break;
+		case 2: unalign_rw(p, 2) = data; break;
+		default: unalign_rw(p, 4) = data; break;
+	}
+}
+
 /* Memory accessing interfaces */
 
+/* An MMIO region is told apart by the page of `addr' alone. */
 uint32_t hwaddr_read(hwaddr_t addr, size_t len) {
-	return dram_read(addr, len) & (~0u >> ((4 - len) << 3));
+#ifdef HAS_DEVICE
+	int map_NO = is_mmio(addr);
+	if(map_NO != -1) { return mmio_read(addr, len, map_NO); }
+#endif
+	if(use_dram) {
+		return dram_read(addr, len) & (~0u >> ((4 - len) << 3));
+	}
+	return flat_read(addr, len);
 }
 
 void hwaddr_write(hwaddr_t addr, size_t len, uint32_t data) {
-	dram_write(addr, len, data);
+#ifdef HAS_DEVICE
+	int map_NO = is_mmio(addr);
+	if(map_NO != -1) {
+		mmio_write(addr, len, data, map_NO);
+		return;
+	}
+#endif
+	uint8_t flag = page_flag[(addr >> PAGE_WIDTH) & (NR_PAGE - 1)] |
+		page_flag[((addr + len - 1) >> PAGE_WIDTH) & (NR_PAGE - 1)];
+	if(flag & PAGE_WATCH) { mem_watch_write(addr, len, data); }
+#ifdef USE_DECODE_CACHE
+	if(flag & PAGE_CODE) { dcache_write(addr, len); }
+#endif
+	if(use_dram) {
+		dram_write(addr, len, data);
+	}
+	else {
+		flat_write(addr, len, data);
+	}
+}
+
+/* An access crossing a page boundary is split into bytes, since the
+ * two pages may be mapped anywhere. */
+static inline bool cross_page(lnaddr_t addr, size_t len) {
+	return (addr & PAGE_OFFSET_MASK) + len > PAGE_OFFSET_MASK + 1;
 }
 
 uint32_t lnaddr_read(lnaddr_t addr, size_t len) {
-	return hwaddr_read(addr, len);
+	if(cross_page(addr, len)) {
+		uint32_t data = 0;
+		int i;
+		for(i = 0; i < len; i ++) {
+			data |= lnaddr_read(addr + i, 1) << (i * 8);
+		}
+		return data;
+	}
+	return hwaddr_read(page_translate(addr, TLB_READ), len);
 }
 
 void lnaddr_write(lnaddr_t addr, size_t len, uint32_t data) {
-	hwaddr_write(addr, len, data);
+	if(cross_page(addr, len)) {
+		int i;
+		for(i = 0; i < len; i ++) {
+			lnaddr_write(addr + i, 1, data >> (i * 8));
+		}
+		return;
+	}
+	hwaddr_write(page_translate(addr, TLB_WRITE), len, data);
 }
 
-uint32_t swaddr_read(swaddr_t addr, size_t len) {
+/* Turn a logical address into a linear one with the cached descriptor.
+ * Segments are expand-up, and accesses beyond the limit are not
+ * supported. */
+static inline lnaddr_t seg_translate(swaddr_t addr, size_t len, uint8_t sreg) {
+	const SegReg *s = &cpu.sreg[sreg];
+	if(s->check_limit) {
+		Assert(addr <= s->limit && len - 1 <= s->limit - addr,
+				"%s:0x%08x is beyond the segment limit 0x%08x", regss[sreg], addr, s->limit);
+	}
+	return s->base + addr;
+}
+
+uint32_t swaddr_read(swaddr_t addr, size_t len, uint8_t sreg) {
 #ifdef DEBUG
 	assert(len == 1 || len == 2 || len == 4);
 #endif
-	return lnaddr_read(addr, len);
+	return lnaddr_read(seg_translate(addr, len, sreg), len);
 }
 
-void swaddr_write(swaddr_t addr, size_t len, uint32_t data) {
+void swaddr_write(swaddr_t addr, size_t len, uint32_t data, uint8_t sreg) {
 #ifdef DEBUG
 	assert(len == 1 || len == 2 || len == 4);
 #endif
-	lnaddr_write(addr, len, data);
+	lnaddr_write(seg_translate(addr, len, sreg), len, data);
+}
+
+/* `[addr, addr + len)' lies within one page. It may be accessed in bulk
+ * if it is in an MMIO region with a bulk callback, or plain memory with
+ * the flat backend, and for a store, if no memory watchpoint covers it.
+ * A bulk store to code invalidates the decode cache here.
+ */
+void *hwaddr_bulk(hwaddr_t addr, size_t len, bool is_write) {
+	if(len == 0) { return NULL; }
+#ifdef HAS_DEVICE
+	int map_NO = is_mmio(addr);
+	if(map_NO != -1) { return mmio_bulk(addr, len, is_write, map_NO); }
+#endif
+	if(use_dram || addr > HW_MEM_SIZE - len) { return NULL; }
+	if(is_write) {
+		uint8_t flag = page_flag[addr >> PAGE_WIDTH];
+		if(flag & PAGE_WATCH) { return NULL; }
+#ifdef USE_DECODE_CACHE
+		if(flag & PAGE_CODE) { dcache_write(addr, len); }
+#endif
+	}
+	return hwa_to_va(addr);
+}
+
+/* Only for segments of 4 GiB, where the range may still cross a page if
+ * the base is not aligned. */
+void *swaddr_bulk(swaddr_t addr, size_t len, bool is_write, uint8_t sreg) {
+	const SegReg *s = &cpu.sreg[sreg];
+	lnaddr_t lnaddr = s->base + addr;
+	if(s->check_limit || cross_page(lnaddr, len)) { return NULL; }
+	return hwaddr_bulk(page_translate(lnaddr, is_write ? TLB_WRITE : TLB_READ), len, is_write);
 }
 
+
+#ifdef USE_FETCH_WINDOW
+FetchWindow fetch_window;
+
+/* `addr' is outside of the fetch window. Move the window to the page
+ * of `addr' if its fetch TLB entry gives a host address, then read
+ * through the usual path. The window covers a page of eip, so it is
+ * only used when CS is a segment of 4 GiB with a page-aligned base, and
+ * it is closed whenever CS is loaded. A fetch crossing the page
+ * boundary always comes here. With the DRAM model every fetch goes
+ * through the model, so that it is counted.
+ */
+uint32_t instr_fetch_slow(swaddr_t addr, size_t len) {
+	const SegReg *cs = &cpu.sreg[R_CS];
+	swaddr_t start = addr & ~(FETCH_PAGE_SIZE - 1);
+	lnaddr_t lnaddr = cs->base + start;
+	TLBEntry *e = tlb_entry(TLB_FETCH, lnaddr);
+
+	fetch_window.size = 0;
+	if(!cs->check_limit && (cs->base & PAGE_OFFSET_MASK) == 0) {
+		page_translate(lnaddr, TLB_FETCH);
+		if(e->tag == tlb_tag(lnaddr)) {
+			fetch_window.start = start;
+			fetch_window.host = (uint8_t *)(e->addend + lnaddr);
+			fetch_window.size = FETCH_PAGE_SIZE;
+		}
+	}
+
+	return swaddr_read(addr, len, R_CS);
+}
+#endif
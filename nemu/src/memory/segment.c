@@ -0,0 +1,67 @@
+#include "nemu.h"
+#include "cpu/decode/decode-cache.h"
+#include "../../../lib-common/x86-inc/mmu.h"
+
+/* The descriptor of a segment register is read from the GDT only here.
+ * In real mode a load only changes the base, as on the real CPU. */
+static void fill_sreg(uint8_t sreg, uint16_t selector) {
+	SegReg *s = &cpu.sreg[sreg];
+	s->selector = selector;
+	if(!cpu.cr0.protect_enable) {
+		s->base = selector << 4;
+		return;
+	}
+
+	if((selector >> 3) == 0) {
+		/* a null selector, any access through it is beyond the limit */
+		Assert(sreg != R_CS && sreg != R_SS, "loading a null selector to %s at eip = 0x%08x", regss[sreg], cpu.eip);
+		s->access = 0;
+		s->base = 0;
+		s->limit = 0;
+		s->check_limit = true;
+		return;
+	}
+
+	uint32_t offset = selector & ~0x7;
+	Assert((selector & 0x4) == 0, "LDT is not supported, selector = 0x%04x", selector);
+	Assert(offset + sizeof(SegDesc) - 1 <= cpu.gdtr.limit, "selector 0x%04x is beyond the GDT limit", selector);
+
+	union {
+		SegDesc desc;
+		uint32_t val[2];
+	} d;
+	d.val[0] = lnaddr_read(cpu.gdtr.base + offset, 4);
+	d.val[1] = lnaddr_read(cpu.gdtr.base + offset + 4, 4);
+	Assert(d.desc.present, "the segment of selector 0x%04x is not present", selector);
+
+	uint32_t limit = (d.desc.limit_19_16 << 16) | d.desc.limit_15_0;
+	if(d.desc.granularity) { limit = (limit << 12) | 0xfff; }
+
+	s->access = d.val[1] >> 8;
+	s->base = (d.desc.base_31_24 << 24) | (d.desc.base_23_16 << 16) | d.desc.base_15_0;
+	s->limit = limit;
+	s->check_limit = (limit != 0xffffffff);
+}
+
+/* The decode cache is indexed by eip, so it is dropped when the base of
+ * CS changes, which is rare. The fetch window covers a page of eip and
+ * is closed on every load of CS. Loads of the other segment registers
+ * invalidate nothing, the decodings only name the segment register.
+ */
+void load_sreg(uint8_t sreg, uint16_t selector) {
+	if(sreg != R_CS) {
+		fill_sreg(sreg, selector);
+		return;
+	}
+
+	uint32_t base = cpu.sreg[R_CS].base;
+	fill_sreg(R_CS, selector);
+#ifdef USE_FETCH_WINDOW
+	fetch_window.size = 0;
+#endif
+#ifdef USE_DECODE_CACHE
+	if(cpu.sreg[R_CS].base != base) { dcache_flush(); }
+#else
+	(void)base;
+#endif
+}
@@ -0,0 +1,116 @@
+#include "nemu.h"
+#include "../../../lib-common/x86-inc/mmu.h"
+
+#ifdef HAS_DEVICE
+#include "device/mmio.h"
+#endif
+
+/* The software TLB, see memory.h. Every access missing the fast path
+ * is translated here, so a page is walked at most once per flush for
+ * each kind of access.
+ */
+
+TLBEntry tlb[NR_TLB_TYPE][NR_TLB];
+uint32_t tlb_gen = 1;
+
+void tlb_flush() {
+	tlb_gen ++;
+	if(tlb_gen > PAGE_OFFSET_MASK) {
+		/* the generation wraps around, drop the stale tags for real */
+		memset(tlb, 0, sizeof(tlb));
+		tlb_gen = 1;
+	}
+#ifdef USE_FETCH_WINDOW
+	fetch_window.size = 0;
+#endif
+}
+
+/* Make the stores to the physical page `paddr' take the slow path,
+ * keeping the translations. */
+void tlb_protect(hwaddr_t paddr) {
+	int i;
+	for(i = 0; i < NR_TLB; i ++) {
+		if(tlb[TLB_WRITE][i].paddr == paddr) {
+			tlb[TLB_WRITE][i].tag = 0;
+		}
+	}
+}
+
+/* Walk the two-level page table, setting the accessed bits, and the
+ * dirty bit for a write. Page faults are not supported. */
+static hwaddr_t page_walk(lnaddr_t addr, bool is_write) {
+	hwaddr_t pde_addr = (cpu.cr3.page_directory_base << PAGE_WIDTH) + (addr >> 22) * sizeof(PDE);
+	PDE pde;
+	pde.val = hwaddr_read(pde_addr, 4);
+	Assert(pde.present, "page fault at eip = 0x%08x: the PDE of 0x%08x is not present", cpu.eip, addr);
+	if(!pde.accessed) {
+		pde.accessed = 1;
+		hwaddr_write(pde_addr, 4, pde.val);
+	}
+
+	hwaddr_t pte_addr = (pde.page_frame << PAGE_WIDTH) + ((addr >> PAGE_WIDTH) & (NR_PTE - 1)) * sizeof(PTE);
+	PTE pte;
+	pte.val = hwaddr_read(pte_addr, 4);
+	Assert(pte.present, "page fault at eip = 0x%08x: the PTE of 0x%08x is not present", cpu.eip, addr);
+	if(!pte.accessed || (is_write && !pte.dirty)) {
+		pte.accessed = 1;
+		pte.dirty |= is_write;
+		hwaddr_write(pte_addr, 4, pte.val);
+	}
+
+	return pte.page_frame << PAGE_WIDTH;
+}
+
+/* Translate `addr' for the monitor. Unlike page_walk(), no accessed or
+ * dirty bit is set and no TLB entry is filled. Return false if the page
+ * is not mapped. */
+bool page_peek(lnaddr_t addr, hwaddr_t *paddr) {
+	if(!(cpu.cr0.protect_enable && cpu.cr0.paging)) {
+		*paddr = addr;
+		return true;
+	}
+
+	PDE pde;
+	pde.val = hwaddr_read((cpu.cr3.page_directory_base << PAGE_WIDTH) + (addr >> 22) * sizeof(PDE), 4);
+	if(!pde.present) { return false; }
+
+	PTE pte;
+	pte.val = hwaddr_read((pde.page_frame << PAGE_WIDTH) + ((addr >> PAGE_WIDTH) & (NR_PTE - 1)) * sizeof(PTE), 4);
+	if(!pte.present) { return false; }
+
+	*paddr = (pte.page_frame << PAGE_WIDTH) | (addr & PAGE_OFFSET_MASK);
+	return true;
+}
+
+/* Whether the host memory of physical page `paddr' may be accessed
+ * directly for an access of `type'. */
+static bool is_plain_page(hwaddr_t paddr, int type) {
+	if(use_dram || paddr > HW_MEM_SIZE - (PAGE_OFFSET_MASK + 1)) { return false; }
+#ifdef HAS_DEVICE
+	if(is_mmio(paddr) != -1) { return false; }
+#endif
+	return type != TLB_WRITE || page_flag[paddr >> PAGE_WIDTH] == 0;
+}
+
+/* Translate the linear address `addr' for an access of `type', and
+ * fill its TLB entry on a miss. */
+hwaddr_t page_translate(lnaddr_t addr, int type) {
+	TLBEntry *e = tlb_entry(type, addr);
+	uint32_t tag = tlb_tag(addr);
+	if(e->ptag != tag) {
+		lnaddr_t page = addr & ~PAGE_OFFSET_MASK;
+		if(cpu.cr0.protect_enable && cpu.cr0.paging) {
+			e->paddr = page_walk(page, type == TLB_WRITE);
+		}
+		else {
+			e->paddr = page;
+		}
+		e->ptag = tag;
+		e->tag = 0;
+		if(is_plain_page(e->paddr, type)) {
+			e->tag = tag;
+			e->addend = (uintptr_t)hwa_to_va(e->paddr) - page;
+		}
+	}
+	return e->paddr | (addr & PAGE_OFFSET_MASK);
+}
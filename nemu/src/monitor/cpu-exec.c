@@ -2,6 +2,12 @@
 #include "cpu/helper.h"
 #include "monitor/watchpoint.h"
 #include "monitor/expr.h"
+#include "monitor/breakpoint.h"
+#include "cpu/jit.h"
+#include "monitor/trace.h"
+#include "monitor/disasm.h"
+#include "cpu/intr.h"
+#include "device/i8259.h"
 #include <setjmp.h>
 
 /* The assembly code of instructions executed is only output to the screen
@@ -15,31 +21,109 @@
 int nemu_state = STOP;
 //初始的 nemu_state 状态为 STOP，表示模拟器当前处于停止状态。
 
-int exec(swaddr_t);
+volatile uint32_t pending_events = 0;
+
+int exec(swaddr_t, Operands *);
+int dcache_exec(swaddr_t, Operands *);
+uint32_t exec_goto(uint32_t);
+extern bool goto_core_enabled;
 //声明函数 exec，参数为 swaddr_t 类型，返回值为 int 类型
 //返回值是变化的，表示执行的指令长度。
 
-char assembly[80];
 char asm_buf[128];
 
 /* Used with exception handling. */
 jmp_buf jbuf;
 
-void print_bin_instr(swaddr_t eip, int len) {
+void print_bin_instr(swaddr_t eip, const uint8_t *instr, int len) {
 	int i;
 	int l = sprintf(asm_buf, "%8x:   ", eip);
 	for(i = 0; i < len; i ++) {
-		l += sprintf(asm_buf + l, "%02x ", instr_fetch(eip + i, 1));
+		l += sprintf(asm_buf + l, "%02x ", instr[i]);
 	}
 	sprintf(asm_buf + l, "%*.s", 50 - (12 + 3 * len), "");
 }
 
+/* The number of instructions requested by the current cpu_exec() */
+static uint32_t nr_instr_requested;
+
+#ifdef DEBUG
+static inline bool tracing() {
+	return trace_enabled || nr_instr_requested < MAX_INSTR_TO_PRINT;
+}
+
+/* The bytes of the instruction at `next_eip', read before it runs, so
+ * that an instruction overwriting itself is traced as it was run. */
+static swaddr_t next_eip;
+static uint8_t next_instr[MAX_INSTR_LEN];
+
+/* Read the bytes at CS:`eip' without touching the accessed bits or the
+ * TLB. Bytes which are not mapped read as 0. */
+static void capture_instr(swaddr_t eip) {
+	lnaddr_t addr = cpu.sreg[R_CS].base + eip;
+	hwaddr_t paddr = 0;
+	bool mapped = false;
+	int i;
+	for(i = 0; i < MAX_INSTR_LEN; i ++, paddr ++) {
+		if(i == 0 || ((addr + i) & PAGE_OFFSET_MASK) == 0) {
+			mapped = page_peek(addr + i, &paddr);
+		}
+		next_instr[i] = (mapped && paddr < HW_MEM_SIZE ? hwaddr_read(paddr, 1) : 0);
+	}
+	next_eip = eip;
+}
+
+/* Trace the instruction just executed at `eip'. Every instruction run
+ * follows either this or the top of the loop in cpu_exec(), which both
+ * capture the instruction at cpu.eip. */
+void trace_instr(swaddr_t eip, int len) {
+	if(!tracing()) { return; }
+	if(eip != next_eip) { capture_instr(eip); }
+	if(len > MAX_INSTR_LEN) { len = MAX_INSTR_LEN; }
+
+	if(trace_enabled) {
+		trace_write(eip, len, next_instr);
+	}
+	if(nr_instr_requested < MAX_INSTR_TO_PRINT) {
+		char assembly[80];
+		disasm(eip, next_instr, len, assembly, sizeof(assembly));
+		print_bin_instr(eip, next_instr, len);
+		printf("%s%s\n", asm_buf, assembly);
+	}
+	capture_instr(cpu.eip);
+}
+#endif
+
 /* This function will be called when an `int3' instruction is being executed. */
 void do_int3() {
 	printf("\nHit breakpoint at eip = 0x%08x\n", cpu.eip);
 	nemu_state = STOP;
 }
 
+/* Return true if the value of some watchpoint has changed. */
+static bool check_watchpoints(swaddr_t eip) {
+	WP* current_wp = get_head_wp();
+	while (current_wp != NULL) {
+		if (current_wp->len != 0 || !expr_deps_changed(&current_wp->code)) {
+			// 内存监视点在写内存时检查；表达式读取的寄存器和内存都没有变化时，值也不会变化
+			current_wp = current_wp->next;
+			continue;
+		}
+		bool success;
+		uint32_t new_value = expr_run(&current_wp->code, &success);
+		if (success && new_value != current_wp->value) {
+			// 监视点值发生变化，触发监视点
+			printf("\nHint watchpoint %d at address 0x%08x\n", current_wp->NO, eip);
+			printf("  %s\n", current_wp->expr);
+			printf("  Old value = %u\n  New value = %u\n", current_wp->value, new_value);
+			current_wp->value = new_value; // 更新值
+			return true;
+		}
+		current_wp = current_wp->next;
+	}
+	return false;
+}
+
 /* Simulate how the CPU works. */
 void cpu_exec(volatile uint32_t n) {
 	//定义函数 cpu_exec，参数为一个 易变的 32位无符号整数 n。
@@ -51,72 +135,99 @@ void cpu_exec(volatile uint32_t n) {
 	//如果 nemu_state 的值为 END，则表示程序已经结束执行，输出提示信息并返回
 	nemu_state = RUNNING;
 	//否则将 nemu_state 的值设置为 RUNNING，表示程序正在运行
+	nr_instr_requested = n;
 #ifdef DEBUG
-	volatile uint32_t n_temp = n;
+	/* Run one instruction at a time when they are printed. */
+	if(n < MAX_INSTR_TO_PRINT) { pending_events |= EVENT_TRACE; }
+	else { pending_events &= ~EVENT_TRACE; }
+#endif
+	/* The first instruction runs alone and ignores the breakpoints, so
+	 * that we can go on after stopping at one. */
+	volatile bool first = true;
+#ifdef DEBUG
+	/* A dot is output each time `n' goes below a multiple of 65536,
+	 * which a batch of instructions may jump over. */
+	volatile uint32_t next_dot = n & ~0xffffu;
 #endif
-	//ifdef和endif之间的代码仅在 宏名 DEBUG 被定义时编译
-	//若DEBUG被定义，则定义一个易变的32位无符号整数 n_temp，并将 n 的值赋给 n_temp
 	setjmp(jbuf);
 
 	for(; n > 0; n --) {
 		//函数执行次数为n。
 #ifdef DEBUG
-		swaddr_t eip_temp = cpu.eip; //swaddr_t 在 common.h 中被定义为 uint32_t 类型
-		//定义一个 swaddr_t 类型（uint32_t类型）的变量 eip_temp，并将 CPU 的指令指针赋值给它
-		if((n & 0xffff) == 0) {
-			//0xffff转换为二进制为16个1，即1111111111111111，若他与n按位与的结果为0，则表示n是65536的倍数。
-			//也就是说，if的条件每65536次n变化一次时成立
-			//若n为-1，转化为二进制是一个极大数，会使条件成立最多次。
+		if(n <= next_dot && next_dot != 0) {
 			/* Output some dots while executing the program. */
 			//翻译：在执行程序时输出一些点
 			fputc('.', stderr);
 			//fputc的定义：int fputc(int char, FILE *stream)，也就是将字符char写入到流stream中
-		}//当n是65536的倍数时，向流 stderr 写入一个点。
+			next_dot = (n - 1) & ~0xffffu;
+		}
+		if(tracing()) { capture_instr(cpu.eip); }
 #endif
 
+		if(pending_events == 0 && !first) {
+			/* Nothing to do between instructions, so run a batch of
+			 * instructions at once. The block cache checks the
+			 * breakpoints when it builds a block. */
+#ifdef USE_GOTO_CORE
+			if(goto_core_enabled && !jit_enabled && nr_bp == 0) {
+				n -= exec_goto(n) - 1;
+				goto instr_done;
+			}
+#endif
+#ifdef USE_BLOCK_CACHE
+			n -= block_exec(n) - 1;
+			goto instr_done;
+#endif
+		}
+
+		swaddr_t eip_temp = cpu.eip; //swaddr_t 在 common.h 中被定义为 uint32_t 类型
+		//定义一个 swaddr_t 类型（uint32_t类型）的变量 eip_temp，并将 CPU 的指令指针赋值给它
+		if(!first && check_bp(eip_temp)) { return; }
+		first = false;
+
 		/* Execute one instruction, including instruction fetch,
 		 * instruction decode, and the actual execution. */
 		//翻译：执行一条指令，包括指令获取、指令解码和实际执行
-		int instr_len = exec(cpu.eip);
+		Operands ops = { .is_operand_size_16 = false, .is_address_size_16 = false };
+#ifdef USE_DECODE_CACHE
+		int instr_len = dcache_exec(cpu.eip, &ops);
+#else
+		int instr_len = exec(cpu.eip, &ops);
+#endif
 		//定义int类型的变量 instr_len，并将 exec 函数的返回值赋给它。
 		cpu.eip += instr_len;
 		//将 CPU 的指令指针寄存器 eip 增加 instr_len，指向下一条指令的地址
 		//这实际上是模拟了 CPU 执行指令后的行为，即更新指令指针以指向下一条指令
 
 #ifdef DEBUG
-		print_bin_instr(eip_temp, instr_len);
-		strcat(asm_buf, assembly);
-		Log_write("%s\n", asm_buf);
-		if(n_temp < MAX_INSTR_TO_PRINT) {
-			printf("%s\n", asm_buf);
-		}
+		trace_instr(eip_temp, instr_len);
 #endif
 //在调试模式下记录每条执行的指令到日志文件
 
-		/* TODO: check watchpoints here. */
-
-WP* current_wp = get_head_wp();
-while (current_wp != NULL) {
-    bool success;
-    uint32_t new_value = expr(current_wp->expr, &success);
-    if (success && new_value != current_wp->value) {
-        // 监视点值发生变化，触发监视点
-        printf("\nHint watchpoint %d at address 0x%08x\n", current_wp->NO, eip_temp);
-        printf("  %s\n", current_wp->expr);
-        printf("  Old value = %u\n  New value = %u\n", current_wp->value, new_value);
-        current_wp->value = new_value; // 更新值
-        nemu_state = STOP;
-        return;
-    }
-    current_wp = current_wp->next;
-}
+		if((pending_events & EVENT_WATCHPOINT) && check_watchpoints(eip_temp)) {
+			nemu_state = STOP;
+		}
 
+#if defined(USE_BLOCK_CACHE) || defined(USE_GOTO_CORE)
+instr_done:
+#endif
 
 #ifdef HAS_DEVICE
-		extern void device_update();
-		device_update();
+		if(pending_events & EVENT_DEVICE) {
+			extern void device_update();
+			pending_events &= ~EVENT_DEVICE;
+			device_update();
+		}
 #endif
 
+		/* While the request is masked, the event stays pending and
+		 * instructions run one at a time until IF is set. */
+		if((pending_events & EVENT_INTR) && cpu.eflags.IF && nemu_state == RUNNING) {
+			uint8_t NO = i8259_query_intr();
+			i8259_ack_intr();
+			raise_intr(NO, cpu.eip);
+		}
+
 		if(nemu_state != RUNNING) { return; }
 	}
 
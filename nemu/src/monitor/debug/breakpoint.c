@@ -0,0 +1,76 @@
+#include "monitor/breakpoint.h"
+#include "cpu/decode/decode-cache.h"
+
+#define NR_BP 32
+
+typedef struct {
+	int NO;
+	bool used;
+	swaddr_t addr;
+} BP;
+
+static BP bp_pool[NR_BP];
+int nr_bp = 0;
+uint32_t bp_page[NR_BP_PAGE / 32];
+
+/* Mark the pages holding breakpoints, and drop the cached code, so that
+ * no cached basic block runs over a breakpoint. The pages are those of
+ * eip, not physical pages, as the breakpoints are set by eip. */
+static void update_bp() {
+	int i;
+	memset(bp_page, 0, sizeof(bp_page));
+	for(i = 0; i < NR_BP; i ++) {
+		if(bp_pool[i].used) {
+			uint32_t page = bp_pool[i].addr >> PAGE_WIDTH;
+			bp_page[page / 32] |= 1u << (page % 32);
+		}
+	}
+#ifdef USE_DECODE_CACHE
+	dcache_flush();
+#endif
+}
+
+/* Return the number of the new breakpoint, or -1 if there is no room. */
+int set_bp(swaddr_t addr) {
+	int i;
+	for(i = 0; i < NR_BP; i ++) {
+		if(!bp_pool[i].used) {
+			bp_pool[i].NO = i;
+			bp_pool[i].used = true;
+			bp_pool[i].addr = addr;
+			nr_bp ++;
+			update_bp();
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool delete_bp(int NO) {
+	if(NO < 0 || NO >= NR_BP || !bp_pool[NO].used) { return false; }
+	bp_pool[NO].used = false;
+	nr_bp --;
+	update_bp();
+	return true;
+}
+
+void list_bp() {
+	int i;
+	if(nr_bp == 0) {
+		printf("No breakpoints currently set.\n");
+		return;
+	}
+	for(i = 0; i < NR_BP; i ++) {
+		if(bp_pool[i].used) {
+			printf("Breakpoint %d at 0x%08x\n", bp_pool[i].NO, bp_pool[i].addr);
+		}
+	}
+}
+
+int find_bp(swaddr_t eip) {
+	int i;
+	for(i = 0; i < NR_BP; i ++) {
+		if(bp_pool[i].used && bp_pool[i].addr == eip) { return i; }
+	}
+	return -1;
+}
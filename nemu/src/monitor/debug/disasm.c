@@ -0,0 +1,488 @@
+#include "monitor/disasm.h"
+#include "cpu/reg.h"
+#include "cpu/decode/modrm.h"
+
+/* The disassembler works on raw bytes only, and does not depend on the
+ * CPU state, so the assembly text is produced only when it is displayed:
+ * by `si', by the trace renderer and by the report of an invalid opcode.
+ * It covers more instructions than NEMU implements.
+ */
+
+enum {
+	F_NONE,
+	F_ESC,			/* 0x0f, two-byte opcode */
+	F_E_G,			/* r -> r/m */
+	F_G_E,			/* r/m -> r */
+	F_I_A,			/* imm -> eAX */
+	F_I_E,			/* imm -> r/m */
+	F_SI_E,			/* sign-extended imm8 -> r/m */
+	F_E,			/* r/m */
+	F_R,			/* the register in the opcode */
+	F_I_R,			/* imm -> the register in the opcode */
+	F_R_A,			/* the register in the opcode <-> eAX */
+	F_I,			/* imm */
+	F_SI,			/* sign-extended imm8 */
+	F_IW,			/* imm16 */
+	F_J,			/* relative jump target */
+	F_O_A,			/* moffs -> eAX */
+	F_A_O,			/* eAX -> moffs */
+	F_1_E,			/* shift r/m by 1 */
+	F_CL_E,			/* shift r/m by %cl */
+	F_IB_E,			/* shift r/m by imm8 */
+	F_I_E_G,		/* imul imm, r/m, r */
+	F_SI_E_G,		/* imul sign-extended imm8, r/m, r */
+	F_IB_G_E,		/* shld/shrd imm8, r, r/m */
+	F_CL_G_E,		/* shld/shrd %cl, r, r/m */
+	F_EB_G,			/* byte r/m -> r, movzx/movsx */
+	F_EW_G,			/* word r/m -> r, movzx/movsx */
+	F_C_R,			/* control register -> r32 */
+	F_R_C,			/* r32 -> control register */
+	F_S_E,			/* segment register -> r/m */
+	F_E_S,			/* r/m -> segment register */
+	F_PTR,			/* far pointer ptr16:32 */
+	F_P_A,			/* port, imm8 or %dx -> eAX */
+	F_A_P,			/* eAX -> port, imm8 or %dx */
+	F_PREFIX
+};
+
+typedef struct {
+	const char *name;
+	uint8_t form;
+	uint8_t size;				/* 0 for the operand size */
+	bool suffix;				/* append the size suffix to the name */
+	const char * const *group;	/* names selected by the ModR/M opcode field */
+} OpcodeEntry;
+
+/* In a group, the name of an indirect jump starts with `*'. */
+static const char * const grp1[] = { "add", "or", "adc", "sbb", "and", "sub", "xor", "cmp" };
+static const char * const grp2[] = { "rol", "ror", "rcl", "rcr", "shl", "shr", "sal", "sar" };
+static const char * const grp3[] = { "test", "test", "not", "neg", "mul", "imul", "div", "idiv" };
+static const char * const grp4[] = { "inc", "dec" , NULL, NULL, NULL, NULL, NULL, NULL };
+static const char * const grp5[] = { "inc", "dec", "*call", NULL, "*jmp", NULL, "push", NULL };
+static const char * const grp7[] = { "sgdt", "sidt", "lgdt", "lidt", "smsw", NULL, "lmsw", "invlpg" };
+
+#define OP(name, form, size) { name, form, size, true, NULL }
+#define OPN(name, form, size) { name, form, size, false, NULL }
+#define GRP(group, form, size) { NULL, form, size, true, group }
+#define GRPN(group, form, size) { NULL, form, size, false, group }
+
+#define ALU(base, name) \
+	[base + 0] = OP(name, F_E_G, 1), [base + 1] = OP(name, F_E_G, 0), \
+	[base + 2] = OP(name, F_G_E, 1), [base + 3] = OP(name, F_G_E, 0), \
+	[base + 4] = OP(name, F_I_A, 1), [base + 5] = OP(name, F_I_A, 0)
+
+#define CC(base, prefix, form, size) \
+	[base + 0x0] = OPN(prefix "o", form, size), [base + 0x1] = OPN(prefix "no", form, size), \
+	[base + 0x2] = OPN(prefix "b", form, size), [base + 0x3] = OPN(prefix "ae", form, size), \
+	[base + 0x4] = OPN(prefix "e", form, size), [base + 0x5] = OPN(prefix "ne", form, size), \
+	[base + 0x6] = OPN(prefix "be", form, size), [base + 0x7] = OPN(prefix "a", form, size), \
+	[base + 0x8] = OPN(prefix "s", form, size), [base + 0x9] = OPN(prefix "ns", form, size), \
+	[base + 0xa] = OPN(prefix "p", form, size), [base + 0xb] = OPN(prefix "np", form, size), \
+	[base + 0xc] = OPN(prefix "l", form, size), [base + 0xd] = OPN(prefix "ge", form, size), \
+	[base + 0xe] = OPN(prefix "le", form, size), [base + 0xf] = OPN(prefix "g", form, size)
+
+static const OpcodeEntry opcode_table[256] = {
+	ALU(0x00, "add"), ALU(0x08, "or"), ALU(0x10, "adc"), ALU(0x18, "sbb"),
+	ALU(0x20, "and"), ALU(0x28, "sub"), ALU(0x30, "xor"), ALU(0x38, "cmp"),
+	[0x0f] = OPN(NULL, F_ESC, 0),
+	[0x40 ... 0x47] = OP("inc", F_R, 0),
+	[0x48 ... 0x4f] = OP("dec", F_R, 0),
+	[0x50 ... 0x57] = OP("push", F_R, 0),
+	[0x58 ... 0x5f] = OP("pop", F_R, 0),
+	[0x60] = OP("pusha", F_NONE, 0),
+	[0x61] = OP("popa", F_NONE, 0),
+	[0x66] = OPN(NULL, F_PREFIX, 0),
+	[0x67] = OPN(NULL, F_PREFIX, 0),
+	[0x68] = OP("push", F_I, 0),
+	[0x69] = OP("imul", F_I_E_G, 0),
+	[0x6a] = OP("push", F_SI, 0),
+	[0x6b] = OP("imul", F_SI_E_G, 0),
+	[0x6c] = OP("ins", F_NONE, 1),
+	[0x6d] = OP("ins", F_NONE, 0),
+	[0x6e] = OP("outs", F_NONE, 1),
+	[0x6f] = OP("outs", F_NONE, 0),
+	CC(0x70, "j", F_J, 1),
+	[0x80] = GRP(grp1, F_I_E, 1),
+	[0x81] = GRP(grp1, F_I_E, 0),
+	[0x83] = GRP(grp1, F_SI_E, 0),
+	[0x84] = OP("test", F_E_G, 1),
+	[0x85] = OP("test", F_E_G, 0),
+	[0x86] = OP("xchg", F_E_G, 1),
+	[0x87] = OP("xchg", F_E_G, 0),
+	[0x88] = OP("mov", F_E_G, 1),
+	[0x89] = OP("mov", F_E_G, 0),
+	[0x8a] = OP("mov", F_G_E, 1),
+	[0x8b] = OP("mov", F_G_E, 0),
+	[0x8c] = OPN("mov", F_S_E, 0),
+	[0x8d] = OP("lea", F_G_E, 0),
+	[0x8e] = OPN("mov", F_E_S, 0),
+	[0x90] = OPN("nop", F_NONE, 0),
+	[0x91 ... 0x97] = OP("xchg", F_R_A, 0),
+	[0x98] = OPN("cwtl", F_NONE, 0),
+	[0x99] = OPN("cltd", F_NONE, 0),
+	[0x9c] = OP("pushf", F_NONE, 0),
+	[0x9d] = OP("popf", F_NONE, 0),
+	[0xa0] = OP("mov", F_O_A, 1),
+	[0xa1] = OP("mov", F_O_A, 0),
+	[0xa2] = OP("mov", F_A_O, 1),
+	[0xa3] = OP("mov", F_A_O, 0),
+	[0xa4] = OP("movs", F_NONE, 1),
+	[0xa5] = OP("movs", F_NONE, 0),
+	[0xa6] = OP("cmps", F_NONE, 1),
+	[0xa7] = OP("cmps", F_NONE, 0),
+	[0xa8] = OP("test", F_I_A, 1),
+	[0xa9] = OP("test", F_I_A, 0),
+	[0xaa] = OP("stos", F_NONE, 1),
+	[0xab] = OP("stos", F_NONE, 0),
+	[0xac] = OP("lods", F_NONE, 1),
+	[0xad] = OP("lods", F_NONE, 0),
+	[0xae] = OP("scas", F_NONE, 1),
+	[0xaf] = OP("scas", F_NONE, 0),
+	[0xb0 ... 0xb7] = OP("mov", F_I_R, 1),
+	[0xb8 ... 0xbf] = OP("mov", F_I_R, 0),
+	[0xc0] = GRP(grp2, F_IB_E, 1),
+	[0xc1] = GRP(grp2, F_IB_E, 0),
+	[0xc2] = OPN("ret", F_IW, 0),
+	[0xc3] = OPN("ret", F_NONE, 0),
+	[0xc6] = OP("mov", F_I_E, 1),
+	[0xc7] = OP("mov", F_I_E, 0),
+	[0xc9] = OPN("leave", F_NONE, 0),
+	[0xcc] = OPN("int3", F_NONE, 0),
+	[0xcd] = OPN("int", F_I, 1),
+	[0xcf] = OPN("iret", F_NONE, 0),
+	[0xd0] = GRP(grp2, F_1_E, 1),
+	[0xd1] = GRP(grp2, F_1_E, 0),
+	[0xd2] = GRP(grp2, F_CL_E, 1),
+	[0xd3] = GRP(grp2, F_CL_E, 0),
+	[0xd6] = OPN("nemu trap", F_NONE, 0),
+	[0xe4] = OPN("in", F_P_A, 1),
+	[0xe5] = OPN("in", F_P_A, 0),
+	[0xe6] = OPN("out", F_A_P, 1),
+	[0xe7] = OPN("out", F_A_P, 0),
+	[0xe8] = OPN("call", F_J, 0),
+	[0xe9] = OPN("jmp", F_J, 0),
+	[0xea] = OPN("ljmp", F_PTR, 0),
+	[0xeb] = OPN("jmp", F_J, 1),
+	[0xec] = OPN("in", F_P_A, 1),
+	[0xed] = OPN("in", F_P_A, 0),
+	[0xee] = OPN("out", F_A_P, 1),
+	[0xef] = OPN("out", F_A_P, 0),
+	[0xf2] = OPN(NULL, F_PREFIX, 0),
+	[0xf3] = OPN(NULL, F_PREFIX, 0),
+	[0xf4] = OPN("hlt", F_NONE, 0),
+	[0xf6] = GRP(grp3, F_E, 1),
+	[0xf7] = GRP(grp3, F_E, 0),
+	[0xfa] = OPN("cli", F_NONE, 0),
+	[0xfb] = OPN("sti", F_NONE, 0),
+	[0xfc] = OPN("cld", F_NONE, 0),
+	[0xfd] = OPN("std", F_NONE, 0),
+	[0xfe] = GRP(grp4, F_E, 1),
+	[0xff] = GRP(grp5, F_E, 0),
+};
+
+static const OpcodeEntry _2byte_opcode_table[256] = {
+	[0x01] = GRPN(grp7, F_E, 4),
+	[0x20] = OPN("mov", F_C_R, 4),
+	[0x22] = OPN("mov", F_R_C, 4),
+	CC(0x80, "j", F_J, 0),
+	CC(0x90, "set", F_E, 1),
+	[0xa4] = OP("shld", F_IB_G_E, 0),
+	[0xa5] = OP("shld", F_CL_G_E, 0),
+	[0xac] = OP("shrd", F_IB_G_E, 0),
+	[0xad] = OP("shrd", F_CL_G_E, 0),
+	[0xaf] = OP("imul", F_G_E, 0),
+	[0xb6] = OP("movzb", F_EB_G, 0),
+	[0xb7] = OP("movzw", F_EW_G, 0),
+	[0xbe] = OP("movsb", F_EB_G, 0),
+	[0xbf] = OP("movsw", F_EW_G, 0),
+};
+
+#undef OP
+#undef OPN
+#undef GRP
+#undef GRPN
+#undef ALU
+#undef CC
+
+static const char * const reg_name[3][8] = {
+	{"al", "cl", "dl", "bl", "ah", "ch", "dh", "bh"},
+	{"ax", "cx", "dx", "bx", "sp", "bp", "si", "di"},
+	{"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"}
+};
+
+static const char * const sreg_name[] = {"es", "cs", "ss", "ds", "fs", "gs"};
+
+#define REG_NAME(size, r) reg_name[(size) == 1 ? 0 : ((size) == 2 ? 1 : 2)][r]
+
+typedef struct {
+	const uint8_t *instr;
+	int len, pos;
+	bool bad;		/* the instruction is truncated */
+	bool addr16;	/* 16-bit addressing forms */
+} Stream;
+
+static uint32_t fetch(Stream *s, int n) {
+	uint32_t val = 0;
+	int i;
+	if(s->pos + n > s->len) {
+		s->bad = true;
+		return 0;
+	}
+	for(i = 0; i < n; i ++) {
+		val |= s->instr[s->pos + i] << (i * 8);
+	}
+	s->pos += n;
+	return val;
+}
+
+static inline int32_t fetch_simm8(Stream *s) {
+	return (int8_t)fetch(s, 1);
+}
+
+/* Format the r/m operand of `size' bytes, the ModR/M byte is fetched. */
+static void format_rm(Stream *s, ModR_M m, int size, char *buf) {
+	if(m.mod == 3) {
+		sprintf(buf, "%%%s", REG_NAME(size, m.R_M));
+		return;
+	}
+
+	int32_t disp = 0;
+	int disp_size = 4;
+	int base_reg = -1, index_reg = -1, scale = 0;
+
+	if(s->addr16) {
+		static const char * const form16[] = {
+			"(%bx,%si)", "(%bx,%di)", "(%bp,%si)", "(%bp,%di)", "(%si)", "(%di)", "(%bp)", "(%bx)"
+		};
+		int l = 0;
+		if(m.mod == 0 && m.R_M == 6) {
+			sprintf(buf, "%#x", fetch(s, 2));
+			return;
+		}
+		if(m.mod != 0) {
+			disp = (m.mod == 1 ? fetch_simm8(s) : (int16_t)fetch(s, 2));
+			l = sprintf(buf, "%s%#x", (disp < 0 ? "-" : ""), (disp < 0 ? -disp : disp));
+		}
+		strcpy(buf + l, form16[m.R_M]);
+		return;
+	}
+
+	if(m.R_M == R_ESP) {
+		SIB sib;
+		sib.val = fetch(s, 1);
+		base_reg = sib.base;
+		scale = sib.ss;
+		if(sib.index != R_ESP) { index_reg = sib.index; }
+	}
+	else { base_reg = m.R_M; }
+
+	if(m.mod == 0) {
+		if(base_reg == R_EBP) { base_reg = -1; }
+		else { disp_size = 0; }
+	}
+	else if(m.mod == 1) { disp_size = 1; }
+
+	int l = 0;
+	if(disp_size != 0) {
+		disp = (disp_size == 1 ? fetch_simm8(s) : fetch(s, 4));
+		l += sprintf(buf, "%s%#x", (disp < 0 ? "-" : ""), (disp < 0 ? -disp : disp));
+	}
+	if(base_reg != -1 || index_reg != -1) {
+		l += sprintf(buf + l, "(");
+		if(base_reg != -1) { l += sprintf(buf + l, "%%%s", REG_NAME(4, base_reg)); }
+		if(index_reg != -1) { l += sprintf(buf + l, ",%%%s,%d", REG_NAME(4, index_reg), 1 << scale); }
+		sprintf(buf + l, ")");
+	}
+	else if(disp_size == 0) { buf[0] = '\0'; }
+}
+
+static inline uint32_t mask(uint32_t val, int size) {
+	return size == 4 ? val : val & ((1u << (size * 8)) - 1);
+}
+
+int disasm(swaddr_t eip, const uint8_t *instr, int len, char *buf, size_t size) {
+	Stream s = { .instr = instr, .len = len, .pos = 0, .bad = false, .addr16 = false };
+	const char *prefix = "";
+	bool is_operand_size_16 = false;
+	uint32_t opcode;
+	const OpcodeEntry *e;
+
+	while(true) {
+		opcode = fetch(&s, 1);
+		e = &opcode_table[opcode];
+		if(s.bad || e->form != F_PREFIX) { break; }
+		switch(opcode) {
+			case 0x66: is_operand_size_16 = true; break;
+			case 0x67: s.addr16 = true; break;
+			case 0xf2: prefix = "repnz "; break;
+			case 0xf3: prefix = "rep "; break;
+		}
+	}
+	if(!s.bad && e->form == F_ESC) {
+		opcode = fetch(&s, 1);
+		e = &_2byte_opcode_table[opcode];
+	}
+	if(s.bad || (e->name == NULL && e->group == NULL)) { goto bad; }
+
+	int op_size = e->size != 0 ? e->size : (is_operand_size_16 ? 2 : 4);
+	const char *name = e->name;
+	int form = e->form;
+	ModR_M m;
+	m.val = 0;
+	if(e->group != NULL) {
+		if(s.pos >= s.len) { goto bad; }
+		m.val = instr[s.pos];
+		name = e->group[m.opcode];
+		if(name == NULL) { goto bad; }
+		/* test in group 3 has an immediate */
+		if(e->group == grp3 && m.opcode <= 1) { form = F_I_E; }
+	}
+
+	bool indirect = (name[0] == '*');
+	if(indirect) { name ++; }
+	if(is_operand_size_16 && e == &opcode_table[0x98]) { name = "cbtw"; }
+	if(is_operand_size_16 && e == &opcode_table[0x99]) { name = "cwtd"; }
+
+	/* the operands in AT&T order, the source comes first */
+	char op[3][40] = { "", "", "" };
+	int nr_op = 0;
+
+	switch(form) {
+		case F_NONE: break;
+		case F_E_G: case F_G_E: case F_EB_G: case F_EW_G: {
+			m.val = fetch(&s, 1);
+			int rm_size = (form == F_EB_G ? 1 : (form == F_EW_G ? 2 : op_size));
+			int rm = (form == F_E_G ? 1 : 0);
+			format_rm(&s, m, rm_size, op[rm]);
+			sprintf(op[1 - rm], "%%%s", REG_NAME(op_size, m.reg));
+			nr_op = 2;
+			break;
+		}
+		case F_I_A:
+			sprintf(op[0], "$0x%x", fetch(&s, op_size));
+			sprintf(op[1], "%%%s", REG_NAME(op_size, R_EAX));
+			nr_op = 2;
+			break;
+		case F_I_E: case F_SI_E: case F_IB_E: case F_1_E: case F_CL_E:
+			m.val = fetch(&s, 1);
+			format_rm(&s, m, op_size, op[1]);
+			switch(form) {
+				case F_I_E: sprintf(op[0], "$0x%x", fetch(&s, op_size)); break;
+				case F_SI_E: sprintf(op[0], "$0x%x", mask(fetch_simm8(&s), op_size)); break;
+				case F_IB_E: sprintf(op[0], "$0x%x", fetch(&s, 1)); break;
+				case F_1_E: sprintf(op[0], "$1"); break;
+				case F_CL_E: sprintf(op[0], "%%cl"); break;
+			}
+			nr_op = 2;
+			break;
+		case F_E:
+			m.val = fetch(&s, 1);
+			op[0][0] = (indirect ? '*' : '\0');
+			format_rm(&s, m, op_size, op[0] + indirect);
+			nr_op = 1;
+			break;
+		case F_R:
+			sprintf(op[0], "%%%s", REG_NAME(op_size, opcode & 0x7));
+			nr_op = 1;
+			break;
+		case F_I_R:
+			sprintf(op[0], "$0x%x", fetch(&s, op_size));
+			sprintf(op[1], "%%%s", REG_NAME(op_size, opcode & 0x7));
+			nr_op = 2;
+			break;
+		case F_R_A:
+			sprintf(op[0], "%%%s", REG_NAME(op_size, opcode & 0x7));
+			sprintf(op[1], "%%%s", REG_NAME(op_size, R_EAX));
+			nr_op = 2;
+			break;
+		case F_I:
+			sprintf(op[0], "$0x%x", fetch(&s, op_size));
+			nr_op = 1;
+			break;
+		case F_SI:
+			sprintf(op[0], "$0x%x", mask(fetch_simm8(&s), op_size));
+			nr_op = 1;
+			break;
+		case F_IW:
+			sprintf(op[0], "$0x%x", fetch(&s, 2));
+			nr_op = 1;
+			break;
+		case F_J: {
+			int32_t rel = (op_size == 1 ? fetch_simm8(&s) : (int32_t)(op_size == 2 ? (int16_t)fetch(&s, 2) : fetch(&s, 4)));
+			sprintf(op[0], "%x", eip + s.pos + rel);
+			nr_op = 1;
+			break;
+		}
+		case F_O_A: case F_A_O: {
+			int src = (form == F_O_A ? 0 : 1);
+			sprintf(op[src], "0x%x", fetch(&s, 4));
+			sprintf(op[1 - src], "%%%s", REG_NAME(op_size, R_EAX));
+			nr_op = 2;
+			break;
+		}
+		case F_I_E_G: case F_SI_E_G:
+			m.val = fetch(&s, 1);
+			format_rm(&s, m, op_size, op[1]);
+			sprintf(op[0], "$0x%x", form == F_I_E_G ? fetch(&s, op_size) : mask(fetch_simm8(&s), op_size));
+			sprintf(op[2], "%%%s", REG_NAME(op_size, m.reg));
+			nr_op = 3;
+			break;
+		case F_IB_G_E: case F_CL_G_E:
+			m.val = fetch(&s, 1);
+			format_rm(&s, m, op_size, op[2]);
+			if(form == F_IB_G_E) { sprintf(op[0], "$0x%x", fetch(&s, 1)); }
+			else { sprintf(op[0], "%%cl"); }
+			sprintf(op[1], "%%%s", REG_NAME(op_size, m.reg));
+			nr_op = 3;
+			break;
+		case F_C_R: case F_R_C: {
+			int cr = (form == F_C_R ? 0 : 1);
+			m.val = fetch(&s, 1);
+			sprintf(op[cr], "%%cr%d", m.reg);
+			sprintf(op[1 - cr], "%%%s", REG_NAME(4, m.R_M));
+			nr_op = 2;
+			break;
+		}
+		case F_S_E: case F_E_S: {
+			int sreg = (form == F_S_E ? 0 : 1);
+			m.val = fetch(&s, 1);
+			if(m.reg >= NR_SREG) { goto bad; }
+			format_rm(&s, m, op_size, op[1 - sreg]);
+			sprintf(op[sreg], "%%%s", sreg_name[m.reg]);
+			nr_op = 2;
+			break;
+		}
+		case F_P_A: case F_A_P: {
+			int port = (form == F_P_A ? 0 : 1);
+			if(opcode & 0x8) { strcpy(op[port], "(%dx)"); }
+			else { sprintf(op[port], "$0x%x", fetch(&s, 1)); }
+			sprintf(op[1 - port], "%%%s", REG_NAME(op_size, R_EAX));
+			nr_op = 2;
+			break;
+		}
+		case F_PTR: {
+			uint32_t offset = fetch(&s, op_size);
+			sprintf(op[0], "$0x%x", fetch(&s, 2));
+			sprintf(op[1], "$0x%x", offset);
+			nr_op = 2;
+			break;
+		}
+		default: goto bad;
+	}
+	if(s.bad) { goto bad; }
+
+	const char suffix[] = { [1] = 'b', [2] = 'w', [4] = 'l' };
+	int l = snprintf(buf, size, "%s%s", prefix, name);
+	if(e->suffix && !indirect && l < (int)size) {
+		l += snprintf(buf + l, size - l, "%c", suffix[op_size]);
+	}
+	int i;
+	for(i = 0; i < nr_op && l < (int)size; i ++) {
+		l += snprintf(buf + l, size - l, "%c%s", (i == 0 ? ' ' : ','), op[i]);
+	}
+	return s.pos;
+
+bad:
+	snprintf(buf, size, "(bad)");
+	return 0;
+}
@@ -10,7 +10,7 @@ static int nr_symtab_entry;
 
 void load_elf_tables(int argc, char *argv[]) { //定义void类型的函数 load_elf_tables，参数为 int 类型的 argc 和 char* 类型的 argv[] 数组
 	int ret; //定义 int 类型的变量 ret 用于存储函数调用的返回值
-	Assert(argc == 2, "run NEMU with format 'nemu [program]'"); 
+	Assert(argc == 2, "run NEMU with format 'nemu [-d] [-g] [-j] [-t FILE] [program]'"); 
 	//调用assert函数，检查 argc 是否等于 2，如果不等于 2 则输出错误信息并终止程序运行
 	//错误信息的翻译是 "以 'nemu [program]' 格式运行 NEMU" 
 
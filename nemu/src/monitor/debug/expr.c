@@ -1,5 +1,6 @@
 #include "nemu.h"
 #include "cpu/reg.h"
+#include "monitor/expr.h"
 #include <sys/types.h>
 #include <regex.h>
 #include <stdlib.h>
@@ -359,10 +360,10 @@ static uint32_t eval(int s, int e, bool *success) {
     }
 }
 
-uint32_t expr(char *e, bool *success) {
+// 词法分析，并识别一元运算符
+static bool tokenize(char *e) {
     if(!make_token(e)) {
-        *success = false;
-        return 0;
+        return false;
     }
     
     // // 调试输出
@@ -422,7 +423,15 @@ uint32_t expr(char *e, bool *success) {
             }
         }
     }
-    
+    return true;
+}
+
+uint32_t expr(char *e, bool *success) {
+    if(!tokenize(e)) {
+        *success = false;
+        return 0;
+    }
+
     *success = true;
 	//    printf("\n开始表达式求值\n");
     uint32_t result = eval(0, nr_token - 1, success);
@@ -435,6 +444,139 @@ uint32_t expr(char *e, bool *success) {
     
     return result;
 }
+/* Compiled expressions for watchpoints. The tokens are translated once
+ * into postfix code, which is run on a small stack. The registers and
+ * memory words read by the last run are kept, so a watchpoint is run
+ * again only after one of them has changed.
+ */
+
+#define EIP_INDEX 8
+
+static int get_register_index(const char *name) {
+    int i;
+    for(i = R_EAX; i <= R_EDI; i ++) {
+        if(strcmp(name, regsl[i]) == 0) { return i; }
+    }
+    if(strcmp(name, "eip") == 0) { return EIP_INDEX; }
+    return -1;
+}
+
+static inline uint32_t read_register(int index) {
+    return index == EIP_INDEX ? cpu.eip : reg_l(index);
+}
+
+static bool emit(ExprCode *c, int op, uint32_t val) {
+    if(c->nr_code >= NR_EXPR_CODE) { return false; }
+    c->code[c->nr_code].op = op;
+    c->code[c->nr_code].val = val;
+    c->nr_code ++;
+    return true;
+}
+
+// 与 eval() 的结构相同，但生成后缀代码而不是求值
+static bool gen(ExprCode *c, int s, int e) {
+    if(s > e) {
+        return false;
+    }
+    else if(s == e) {
+        switch(tokens[s].type) {
+            case REG: {
+                int index = get_register_index(tokens[s].str + 1); // 跳过'$'
+                if(index < 0) { return false; }
+                c->reg_mask |= 1u << index;
+                return emit(c, REG, index);
+            }
+            case NUM: return emit(c, NUM, atoi(tokens[s].str));
+            case HEX: return emit(c, NUM, strtol(tokens[s].str, NULL, 16));
+            default: return false;
+        }
+    }
+    else if(tokens[s].type == '(' && tokens[e].type == ')') {
+        return gen(c, s + 1, e - 1);
+    }
+
+    bool success;
+    int dominated_op = find_dominated_op(s, e, &success);
+    if(!success) { return false; }
+
+    int op_type = tokens[dominated_op].type;
+    if(op_type == NOT || op_type == NEG || op_type == REF) {
+        return gen(c, dominated_op + 1, e) && emit(c, op_type, 0);
+    }
+    return gen(c, s, dominated_op - 1) && gen(c, dominated_op + 1, e) && emit(c, op_type, 0);
+}
+
+bool expr_compile(char *e, ExprCode *c) {
+    c->nr_code = 0;
+    c->reg_mask = 0;
+    c->nr_load = 0;
+    return tokenize(e) && gen(c, 0, nr_token - 1);
+}
+
+uint32_t expr_run(ExprCode *c, bool *success) {
+    uint32_t stack[NR_EXPR_CODE];
+    int sp = 0, i;
+
+    c->nr_load = 0;
+    for(i = R_EAX; i <= EIP_INDEX; i ++) {
+        if(c->reg_mask & (1u << i)) { c->reg_val[i] = read_register(i); }
+    }
+
+    for(i = 0; i < c->nr_code; i ++) {
+        uint32_t val = c->code[i].val;
+        switch(c->code[i].op) {
+            case NUM: stack[sp ++] = val; break;
+            case REG: stack[sp ++] = c->reg_val[val]; break;
+            case NOT: stack[sp - 1] = !stack[sp - 1]; break;
+            case NEG: stack[sp - 1] = -stack[sp - 1]; break;
+            case REF: {
+                hwaddr_t addr = stack[sp - 1];
+                stack[sp - 1] = hwaddr_read(addr, 4);
+                if(c->nr_load < NR_EXPR_CODE) {
+                    c->load_addr[c->nr_load] = addr;
+                    c->load_val[c->nr_load] = stack[sp - 1];
+                    c->nr_load ++;
+                }
+                break;
+            }
+            default: {
+                uint32_t right = stack[-- sp], left = stack[sp - 1], result;
+                switch(c->code[i].op) {
+                    case '+': result = left + right; break;
+                    case '-': result = left - right; break;
+                    case '*': result = left * right; break;
+                    case '/':
+                        if(right == 0) { *success = false; return 0; }
+                        result = left / right;
+                        break;
+                    case EQ: result = (left == right); break;
+                    case NEQ: result = (left != right); break;
+                    case AND: result = (left && right); break;
+                    default: result = (left || right); break;
+                }
+                stack[sp - 1] = result;
+                break;
+            }
+        }
+    }
+
+    *success = true;
+    return stack[0];
+}
+
+/* Return true if some register or memory word read by the last
+ * expr_run() has changed since then. */
+bool expr_deps_changed(const ExprCode *c) {
+    int i;
+    for(i = R_EAX; i <= EIP_INDEX; i ++) {
+        if((c->reg_mask & (1u << i)) && read_register(i) != c->reg_val[i]) { return true; }
+    }
+    for(i = 0; i < c->nr_load; i ++) {
+        if(hwaddr_read(c->load_addr[i], 4) != c->load_val[i]) { return true; }
+    }
+    return false;
+}
+
 //p (!($ecx != 0x00008000) &&($eax ==0x00000000))+0x12345678
 //p 0xc0100000-(($edx+0x1234-10)*16)/4
 //标记任务5完成
\ No newline at end of file
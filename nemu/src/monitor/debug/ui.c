@@ -2,12 +2,16 @@
 #include "monitor/expr.h"
 #include "monitor/watchpoint.h"
 #include "nemu.h"
+#include "cpu/eflags.h"
+#include "monitor/breakpoint.h"
 
 #include <stdlib.h>
 #include <readline/readline.h>
 #include <readline/history.h>
 
 void cpu_exec(uint32_t);
+void print_ddr3_stats();
+void print_fusion_stats();
 
 /* We use the `readline' library to provide more flexibility to read from stdin. */
 char* rl_gets() {
@@ -52,6 +56,10 @@ static int cmd_d(char *args);
 
 static int cmd_w(char *args);
 
+static int cmd_b(char *args);
+
+static int cmd_bd(char *args);
+
 static struct {
 	char *name;
 	char *description;
@@ -61,11 +69,13 @@ static struct {
 	{ "c", "Continue the execution of the program", cmd_c },
 	{ "q", "Exit NEMU", cmd_q },
 	{ "si", "The program pauses after single-stepping through N instructions. If N is not specified, it defaults to 1.",cmd_si},
-	{ "info","Print register status[r] or watchpoint information[w]",cmd_info},
+	{ "info","Print register status[r], watchpoint information[w], breakpoints[b], DRAM row buffer statistics[d] or superinstruction statistics[f]",cmd_info},
 	{ "x","Examine memory at a given address",cmd_x},
 	{ "p","Calculate the value of the expression EXPR.", cmd_p},
 	{ "d","Delete the monitoring point by number",cmd_d},
-	{ "w", "Set a watchpoint for an expression", cmd_w}
+	{ "w", "Set a watchpoint for an expression, or for stores to a physical memory range with 'w -l ADDR LEN'", cmd_w},
+	{ "b", "Set a breakpoint at ADDR", cmd_b},
+	{ "bd", "Delete the breakpoint by number", cmd_bd}
 	/* TODO: Add more commands */
 
 };
@@ -112,7 +122,7 @@ static int cmd_si(char *args) {
 static int cmd_info(char*args){
     char *arg = strtok(NULL," ");
     if(arg == NULL){
-        printf("Please specify 'r' for registers or 'w' for watchpoints.\n");
+        printf("Please specify 'r' for registers, 'w' for watchpoints, 'b' for breakpoints, 'd' for DRAM or 'f' for superinstructions.\n");
         return 0;
     }
     else{
@@ -123,6 +133,9 @@ static int cmd_info(char*args){
             printf("$edx (0x%08x)\n", cpu.gpr[2]._32);
             printf("$ebx (0x%08x)\n", cpu.gpr[3]._32);
 			//printf("$eip (0x%08x)\n", cpu.eip); // 打印eip
+            eflags_sync();
+            printf("$eflags (0x%08x) CF=%d PF=%d ZF=%d SF=%d OF=%d\n", cpu.eflags.val,
+                   cpu.eflags.CF, cpu.eflags.PF, cpu.eflags.ZF, cpu.eflags.SF, cpu.eflags.OF);
             return 0;
         }
         else if(strcmp(arg,"w")==0){
@@ -133,20 +146,58 @@ static int cmd_info(char*args){
             } else {
                 printf("Watchpoint list:\n");
                 while(current != NULL) {
-                    printf("Watchpoint %d: %s = %u (0x%x)\n", 
-                           current->NO, current->expr, current->value, current->value);
+                    if(current->len != 0) {
+                        printf("Watchpoint %d: %s\n", current->NO, current->expr);
+                    } else {
+                        printf("Watchpoint %d: %s = %u (0x%x)\n", 
+                               current->NO, current->expr, current->value, current->value);
+                    }
                     current = current->next;
                 }
             }
             return 0;
         }
+        else if(strcmp(arg,"b")==0){
+            list_bp();
+            return 0;
+        }
+        else if(strcmp(arg,"d")==0){
+            //打印 DRAM 每个 bank 的行缓冲命中统计
+            if(!use_dram) {
+                printf("The DRAM model is not used, run NEMU with '-d'.\n");
+            }
+            else {
+                print_ddr3_stats();
+            }
+            return 0;
+        }
+        else if(strcmp(arg,"f")==0){
+            //打印每种融合指令执行的次数
+            print_fusion_stats();
+            return 0;
+        }
         else{
-            printf("Unknown argument '%s'. Please specify 'r' for registers or 'w' for watchpoints.\n",arg);
+            printf("Unknown argument '%s'. Please specify 'r' for registers, 'w' for watchpoints, 'b' for breakpoints, 'd' for DRAM or 'f' for superinstructions.\n",arg);
             return 0;
         }
 	}
 }
 
+/* Read the word at DS:`addr' without touching the accessed and dirty
+ * bits or the TLB. Return false if it is not mapped. */
+static bool peek_word(swaddr_t addr, uint32_t *data) {
+	const SegReg *s = &cpu.sreg[R_DS];
+	if(s->check_limit && (addr > s->limit || s->limit - addr < 3)) { return false; }
+	int i;
+	*data = 0;
+	for(i = 3; i >= 0; i --) {
+		hwaddr_t paddr;
+		if(!page_peek(s->base + addr + i, &paddr) || paddr >= HW_MEM_SIZE) { return false; }
+		*data = (*data << 8) | hwaddr_read(paddr, 1);
+	}
+	return true;
+}
+
 static int cmd_x(char *args) {
 	char *arg1 = strtok(NULL, " ");
 	char *arg2 = strtok(NULL, " ");
@@ -168,7 +219,11 @@ static int cmd_x(char *args) {
         swaddr_t base_addr = strtoul(arg2, NULL, 16);
         for(i = 0; i < N; i++){
             swaddr_t addr = base_addr + i*4;
-            uint32_t data = swaddr_read(addr, 4); // 读取4字节内容
+            uint32_t data;
+            if(!peek_word(addr, &data)) { // 读取4字节内容
+                printf("0x%08x: not mapped", addr);
+                break;
+            }
             printf("0x%08x ", data);
             //打印从base_addr开始的N个4字节内容
         }
@@ -230,6 +285,24 @@ static int cmd_w(char *args) {
         return 0;
     }
     
+    if (strncmp(args, "-l ", 3) == 0) {
+        // 内存监视点：w -l ADDR LEN，ADDR 是物理地址
+        char *end;
+        hwaddr_t addr = strtoul(args + 3, &end, 0);
+        size_t len = strtoul(end, &end, 0);
+        if (len == 0) {
+            printf("Usage: w -l ADDR LEN\n");
+            return 0;
+        }
+        if (addr >= HW_MEM_SIZE || len > HW_MEM_SIZE - addr) {
+            printf("[0x%08x, 0x%08x) is not in physical memory\n", addr, (unsigned)(addr + len));
+            return 0;
+        }
+        WP* wp = create_mem_wp(addr, len);
+        printf("Watchpoint %d created for stores to physical [0x%08x, 0x%08x)\n", wp->NO, addr, (unsigned)(addr + len));
+        return 0;
+    }
+
     WP* wp = create_wp(args);
     if (wp == NULL) {
         printf("Failed to create watchpoint for expression: %s\n", args);
@@ -240,6 +313,43 @@ static int cmd_w(char *args) {
     return 0;
 }
 
+static int cmd_b(char *args) {
+    if (args == NULL || *args == '\0') {
+        printf("Usage: b ADDR\n");
+        return 0;
+    }
+
+    bool success;
+    swaddr_t addr = expr(args, &success);
+    if (!success) {
+        printf("Invalid expression.\n");
+        return 0;
+    }
+
+    int NO = set_bp(addr);
+    if (NO < 0) {
+        printf("No free breakpoint\n");
+        return 0;
+    }
+    printf("Breakpoint %d at 0x%08x\n", NO, addr);
+    return 0;
+}
+
+static int cmd_bd(char *args) {
+    if (args == NULL || *args == '\0') {
+        printf("Usage: bd BP_NUM\n");
+        return 0;
+    }
+
+    int NO = atoi(args);
+    if (delete_bp(NO)) {
+        printf("Deleted breakpoint %d\n", NO);
+    } else {
+        printf("Breakpoint %d not found\n", NO);
+    }
+    return 0;
+}
+
 void ui_mainloop() {
 	while(1) {
 		char *str = rl_gets();
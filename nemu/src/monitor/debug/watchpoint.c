@@ -1,5 +1,7 @@
 #include "monitor/watchpoint.h"
 #include "monitor/expr.h"
+#include "monitor/monitor.h"
+#include "nemu.h"
 
 #define NR_WP 32
 
@@ -17,6 +19,34 @@ WP* new_wp();
 void free_wp(WP* wp);
 WP* create_wp(char *expression);
 
+// 根据当前的监视点，更新 EVENT_WATCHPOINT 和被监视的内存页
+static void update_watch_state() {
+    bool has_expr = false;
+    int i;
+    for(i = 0; i < NR_PAGE; i ++) {
+        page_flag[i] &= ~PAGE_WATCH;
+    }
+
+    WP* wp;
+    for(wp = head; wp != NULL; wp = wp->next) {
+        if(wp->len == 0) {
+            has_expr = true;
+        }
+        else {
+            // 内存监视点不需要每条指令检查，只标记所在的页
+            hwaddr_t page;
+            for(page = wp->addr >> PAGE_WIDTH; page <= (wp->addr + wp->len - 1) >> PAGE_WIDTH; page ++) {
+                page_flag[page & (NR_PAGE - 1)] |= PAGE_WATCH;
+            }
+        }
+    }
+
+    tlb_flush();
+
+    if(has_expr) { pending_events |= EVENT_WATCHPOINT; }
+    else { pending_events &= ~EVENT_WATCHPOINT; }
+}
+
 WP* new_wp(){
     //若没有空闲监视点
     if(free_ == NULL){ //表示指针为空 使用NULL
@@ -32,6 +62,7 @@ WP* new_wp(){
         // 初始化新添加的成员
         new_wp->expr[0] = '\0';  // 清空表达式
         new_wp->value = 0;       // 初始化值为0
+        new_wp->len = 0;         // 默认为表达式监视点
 
         new_wp->next = head; // new_wp的next指向head
         head = new_wp;       // head指向new_wp
@@ -73,6 +104,8 @@ void free_wp(WP* wp){
             //插入到free_
             cur->next = free_;
             free_ = cur;
+
+            update_watch_state();
         }
     }
 }
@@ -84,18 +117,42 @@ WP* create_wp(char *expression) {
         strncpy(wp->expr, expression, sizeof(wp->expr) - 1);
         wp->expr[sizeof(wp->expr) - 1] = '\0'; // 确保字符串结束
         
-        // 计算表达式的初始值
-        bool success;
-        wp->value = expr(expression, &success);
+        // 编译表达式，并计算初始值
+        bool success = expr_compile(wp->expr, &wp->code);
+        if (success) {
+            wp->value = expr_run(&wp->code, &success);
+        }
         if (!success) {
             // 如果表达式计算失败，释放监视点
             free_wp(wp);
             return NULL;
         }
+        update_watch_state();
     }
     return wp;
 }
 
+WP* create_mem_wp(hwaddr_t addr, size_t len) {
+    WP* wp = new_wp();
+    snprintf(wp->expr, sizeof(wp->expr), "-l 0x%08x %u", addr, (unsigned)len);
+    wp->addr = addr;
+    wp->len = len;
+    update_watch_state();
+    return wp;
+}
+
+// 写入被监视的页时由 hwaddr_write() 调用，检查是否写入了被监视的范围
+void mem_watch_write(hwaddr_t addr, size_t len, uint32_t data) {
+    WP* wp;
+    for(wp = head; wp != NULL; wp = wp->next) {
+        if(wp->len != 0 && addr < wp->addr + wp->len && wp->addr < addr + len) {
+            printf("\nHit memory watchpoint %d at eip = 0x%08x\n", wp->NO, cpu.eip);
+            printf("  write %u byte(s) of 0x%x to 0x%08x\n", (unsigned)len, data, addr);
+            nemu_state = STOP;
+        }
+    }
+}
+
 void init_wp_pool() {
     int i;
     for(i = 0; i < NR_WP; i ++) {
@@ -105,5 +162,6 @@ void init_wp_pool() {
     wp_pool[NR_WP - 1].next = NULL;       //最后一个监视点的next指向NULL
 
     head = NULL;    //初始化，最初没有监视点被使用
+    update_watch_state();
     free_ = wp_pool;//最初整个监视点池都是空闲的
 }//初始化
\ No newline at end of file
@@ -1,4 +1,9 @@
 #include "nemu.h"
+#include "cpu/jit.h"
+#include "monitor/trace.h"
+
+#include <stdlib.h>
+#include <unistd.h>
 
 #define ENTRY_START 0x100000
 
@@ -10,6 +15,45 @@ void load_elf_tables(int, char *[]);
 void init_regex();
 void init_wp_pool();
 void init_ddr3();
+extern bool goto_core_enabled;
+
+static void usage(char *name) {
+	printf("Usage: %s [-d] [-g] [-j] [-t FILE] [program]\n", name);
+	printf("  -d    access memory through the DRAM model instead of flat memory\n");
+	printf("  -g    interpret with the computed-goto loop (needs USE_GOTO_CORE)\n");
+	printf("  -j    translate hot basic blocks to host code\n");
+	printf("  -t    write a binary instruction trace to FILE (needs DEBUG)\n");
+	exit(1);
+}
+
+/* Parse the options, and return the index of the program in `argv'. */
+static int parse_args(int argc, char *argv[]) {
+	int c;
+	while((c = getopt(argc, argv, "dgjt:")) != -1) {
+		switch(c) {
+			case 'd': use_dram = true; break;
+			case 'g':
+#ifdef USE_GOTO_CORE
+				goto_core_enabled = true;
+				break;
+#else
+				printf("-g needs NEMU to be built with USE_GOTO_CORE defined in common.h\n");
+				exit(1);
+#endif
+			case 'j': jit_enabled = true; break;
+			case 't':
+#ifdef DEBUG
+				init_trace(optarg);
+				break;
+#else
+				printf("-t needs NEMU to be built with DEBUG defined in common.h\n");
+				exit(1);
+#endif
+			default: usage(argv[0]);
+		}
+	}
+	return optind;
+}
 
 FILE *log_fp = NULL; //定义日志文件指针 *log_fp 最初值为 NULL；FILE 的意义是文件流结构体，包含了文件操作的各种信息。
                      //所有文件操作相关的函数 都用FILE*类型的指针作为参数
@@ -35,6 +79,11 @@ void init_monitor(int argc, char *argv[]) {
 	//翻译：打开日志文件 
 	init_log(); //执行初始化日志的函数 此函数定义位于本文件第15行 
 
+	/* Parse the options before the program name. */
+	int prog = parse_args(argc, argv);
+	argc -= prog - 1;
+	argv += prog - 1;
+
 	/* Load the string table and symbol table from the ELF file for future use. */
 	//翻译：从 ELF 文件加载字符串表和符号表以供将来使用
 	//ELF文件是一种可执行文件格式，包含了程序的机器代码、数据段、符号表等信息
@@ -48,6 +97,8 @@ void init_monitor(int argc, char *argv[]) {
 	/* Initialize the watchpoint pool. */
 	init_wp_pool();
 
+	if(jit_enabled) { init_jit(); }
+
 	/* Display welcome message. */
 	welcome();
 }
@@ -120,6 +171,23 @@ void restart() {
 	/* Set the initial instruction pointer. */
 	cpu.eip = ENTRY_START; //设置 CPU 的指令指针寄存器 eip 的初始值为 ENTRY_START（0x100000），也就是内存的起始地址
 
+	/* Start in real mode without paging, with segments of 4 GiB based at 0,
+	 * so that the entry code runs in a flat address space. */
+	cpu.cr0.val = 0;
+	cpu.cr3.val = 0;
+	int i;
+	for(i = 0; i < NR_SREG; i ++) {
+		cpu.sreg[i] = (SegReg){ .selector = 0, .access = (i == R_CS ? 0x9b : 0x93),
+			.check_limit = false, .base = 0, .limit = 0xffffffff };
+	}
+	cpu.gdtr.limit = 0;
+	cpu.gdtr.base = 0;
+	cpu.idtr.limit = 0;
+	cpu.idtr.base = 0;
+	tlb_flush();
+	/* the program was read in behind the back of the decode cache */
+	dcache_flush();
+
 	/* Initialize DRAM. */
 	init_ddr3();
 	//调用 init_ddr3 函数初始化 DRAM，根据定义，DRAM 初始化包括将所有行缓冲区的 valid 字段设置为 false
@@ -0,0 +1,104 @@
+#include "cpu/helper.h"
+#include "monitor/trace.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* The records are put into a single-producer single-consumer ring by
+ * the CPU thread, and a writer thread drains the ring to the file in
+ * large blocks. The CPU thread waits only when the ring is full.
+ */
+
+#define NR_TRACE_RING (1 << 16)
+
+static TraceRecord ring[NR_TRACE_RING];
+static uint32_t ring_head;	/* written by the CPU thread */
+static uint32_t ring_tail;	/* written by the writer thread */
+static bool stopping;
+
+static FILE *trace_fp;
+static pthread_t writer;
+static uint32_t last_gpr[8];
+
+bool trace_enabled = false;
+
+static void *trace_writer(void *arg) {
+	while(1) {
+		uint32_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+		uint32_t tail = ring_tail;
+		if(head == tail) {
+			if(__atomic_load_n(&stopping, __ATOMIC_ACQUIRE)) { break; }
+			usleep(1000);
+			continue;
+		}
+
+		/* write up to the end of the ring at once */
+		uint32_t offset = tail & (NR_TRACE_RING - 1);
+		uint32_t nr = head - tail;
+		if(nr > NR_TRACE_RING - offset) { nr = NR_TRACE_RING - offset; }
+		size_t ret = fwrite(&ring[offset], sizeof(TraceRecord), nr, trace_fp);
+		Assert(ret == nr, "Can not write the trace");
+		__atomic_store_n(&ring_tail, tail + nr, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+/* Drain the ring and close the file, called at exit. */
+static void stop_trace() {
+	if(trace_fp == NULL || pthread_equal(pthread_self(), writer)) { return; }
+	__atomic_store_n(&stopping, true, __ATOMIC_RELEASE);
+	pthread_join(writer, NULL);
+	fclose(trace_fp);
+	trace_fp = NULL;
+}
+
+/* A failed Assert() aborts without running the atexit() handlers, but
+ * the last instructions are the interesting ones then. */
+static void abort_handler(int sig) {
+	stop_trace();
+}
+
+void init_trace(const char *file) {
+	trace_fp = fopen(file, "wb");
+	Assert(trace_fp, "Can not open '%s'", file);
+	fwrite(TRACE_MAGIC, strlen(TRACE_MAGIC), 1, trace_fp);
+
+	int ret = pthread_create(&writer, NULL, trace_writer, NULL);
+	Assert(ret == 0, "Can not create the trace writer");
+	atexit(stop_trace);
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = abort_handler;
+	sa.sa_flags = SA_RESETHAND;
+	sigaction(SIGABRT, &sa, NULL);
+	trace_enabled = true;
+}
+
+/* Record the instruction of `len' bytes at `eip' which has just run.
+ * `bytes' are the bytes it was read from before it ran. */
+void trace_write(swaddr_t eip, int len, const uint8_t *bytes) {
+	uint32_t head = ring_head;
+	while(head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) == NR_TRACE_RING) {
+		sched_yield();
+	}
+
+	TraceRecord *r = &ring[head & (NR_TRACE_RING - 1)];
+	int i;
+	r->eip = eip;
+	r->len = len;
+	memcpy(r->bytes, bytes, MAX_INSTR_LEN);
+	r->reg_mask = 0;
+	for(i = R_EAX; i <= R_EDI; i ++) {
+		r->gpr[i] = reg_l(i);
+		if(r->gpr[i] != last_gpr[i]) {
+			r->reg_mask |= 1 << i;
+			last_gpr[i] = r->gpr[i];
+		}
+	}
+
+	__atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+}
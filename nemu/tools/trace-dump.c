@@ -0,0 +1,53 @@
+#include "monitor/trace.h"
+#include "monitor/disasm.h"
+
+#include <stdlib.h>
+
+/* Render a binary trace written by `nemu -t FILE' as text. */
+
+static const char *regsl[] = {"eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi"};
+
+int main(int argc, char *argv[]) {
+	if(argc != 2) {
+		fprintf(stderr, "Usage: %s TRACE_FILE\n", argv[0]);
+		return 1;
+	}
+
+	FILE *fp = fopen(argv[1], "rb");
+	if(fp == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	char magic[sizeof(TRACE_MAGIC) - 1];
+	if(fread(magic, sizeof(magic), 1, fp) != 1 || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0) {
+		fprintf(stderr, "%s is not a NEMU trace\n", argv[1]);
+		return 1;
+	}
+
+	static TraceRecord buf[4096];
+	size_t nr, i;
+	while((nr = fread(buf, sizeof(TraceRecord), 4096, fp)) > 0) {
+		for(i = 0; i < nr; i ++) {
+			TraceRecord *r = &buf[i];
+			int j, l = 0;
+			char line[128];
+			l += sprintf(line, "%8x:   ", r->eip);
+			for(j = 0; j < r->len && j < MAX_INSTR_LEN; j ++) {
+				l += sprintf(line + l, "%02x ", r->bytes[j]);
+			}
+			char assembly[80];
+			disasm(r->eip, r->bytes, r->len, assembly, sizeof(assembly));
+			printf("%-50s%-40s", line, assembly);
+			for(j = 0; j < 8; j ++) {
+				if(r->reg_mask & (1 << j)) {
+					printf(" %s=0x%08x", regsl[j], r->gpr[j]);
+				}
+			}
+			printf("\n");
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
@@ -0,0 +1,36 @@
+#include "trap.h"
+
+/* or, and, sub, xor and mov between a register and a register or
+ * memory r/m, with every operand size and in both directions. NEMU
+ * runs these through specialized handlers. */
+
+#define A 0x12345678u
+#define B 0x8080f0f1u
+
+#define TEST(sfx, type, rc, op, res) do { \
+	type x = (type)A, y = (type)B, m = (type)B; \
+	asm volatile(op sfx " %1, %0" : "+" rc (x) : rc (y)); \
+	nemu_assert(x == (type)(res)); \
+	x = (type)A; \
+	asm volatile(op sfx " %1, %0" : "+" rc (x) : "m" (m)); \
+	nemu_assert(x == (type)(res)); \
+	m = (type)A; \
+	asm volatile(op sfx " %1, %0" : "+m" (m) : rc (y)); \
+	nemu_assert(m == (type)(res)); \
+} while(0)
+
+#define TEST_ALL(op, res) do { \
+	TEST("b", unsigned char, "q", op, res); \
+	TEST("w", unsigned short, "r", op, res); \
+	TEST("l", unsigned int, "r", op, res); \
+} while(0)
+
+int main() {
+	TEST_ALL("or", A | B);
+	TEST_ALL("and", A & B);
+	TEST_ALL("sub", A - B);
+	TEST_ALL("xor", A ^ B);
+	TEST_ALL("mov", B);
+
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "trap.h"
+
+/* add in its register, memory and immediate forms, and leave. The frame
+ * below also has the pairs NEMU runs fused: push %ebp + mov %esp,%ebp,
+ * mov + add on a register, and leave + ret. */
+
+int frame(int a, int b);
+asm(".globl frame\n"
+	"frame:\n"
+	"	push %ebp\n"
+	"	mov %esp, %ebp\n"
+	"	sub $16, %esp\n"
+	"	mov 8(%ebp), %ecx\n"
+	"	mov %ecx, %eax\n"
+	"	add 12(%ebp), %eax\n"
+	"	mov %eax, %edx\n"
+	"	add %ecx, %edx\n"
+	"	mov $100, %eax\n"
+	"	add $0x12345, %eax\n"
+	"	add %edx, %eax\n"
+	"	leave\n"
+	"	ret\n");
+
+#define A 0x12345678u
+#define B 0x8080f0f1u
+
+#define TEST(sfx, type, rc, res) do { \
+	type x = (type)A, y = (type)B, m = (type)B; \
+	asm volatile("add" sfx " %1, %0" : "+" rc (x) : rc (y)); \
+	nemu_assert(x == (type)(res)); \
+	x = (type)A; \
+	asm volatile("add" sfx " %1, %0" : "+" rc (x) : "m" (m)); \
+	nemu_assert(x == (type)(res)); \
+	m = (type)A; \
+	asm volatile("add" sfx " %1, %0" : "+m" (m) : rc (y)); \
+	nemu_assert(m == (type)(res)); \
+	x = (type)A; \
+	asm volatile("add" sfx " %1, %0" : "+" rc (x) : "i" ((type)B)); \
+	nemu_assert(x == (type)(res)); \
+} while(0)
+
+int main() {
+	int i, cf;
+	unsigned x;
+
+	TEST("b", unsigned char, "q", A + B);
+	TEST("w", unsigned short, "r", A + B);
+	TEST("l", unsigned int, "r", A + B);
+
+	x = 0xffffffff;
+	asm volatile("addl $1, %0" : "+r"(x), "=@ccc"(cf));
+	nemu_assert(x == 0 && cf);
+
+	for(i = 0; i < 100; i ++) {
+		nemu_assert(frame(i, 3 * i) == 100 + 0x12345 + 5 * i);
+	}
+
+	return 0;
+}
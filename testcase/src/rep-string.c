@@ -0,0 +1,78 @@
+#include "trap.h"
+
+/* rep string instructions, which NEMU runs a page at a time over host
+ * memory. Besides the data, the final ECX, ESI, EDI and ZF must match
+ * element-by-element execution. */
+
+#define PAGE 4096
+
+char a[3 * PAGE] __attribute__((aligned(PAGE)));
+char b[3 * PAGE] __attribute__((aligned(PAGE)));
+unsigned w[16];
+unsigned v[16];
+
+unsigned ecx;
+char *esi, *edi;
+int zf;
+
+#define REP(instr, eax) \
+	asm volatile(instr : "+c"(ecx), "+S"(esi), "+D"(edi), "=@ccz"(zf) : "a"(eax) : "memory")
+
+int main() {
+	int i;
+
+	/* DF = 1 copies backwards */
+	for(i = 0; i < 16; i ++) { w[i] = i * 0x01010101; }
+	ecx = 16; esi = (char *)&w[15]; edi = (char *)&v[15];
+	REP("std; rep movsl; cld", 0);
+	nemu_assert(ecx == 0 && (unsigned)esi == (unsigned)w - 4 && (unsigned)edi == (unsigned)v - 4);
+	for(i = 0; i < 16; i ++) { nemu_assert(v[i] == i * 0x01010101); }
+
+	/* a forward copy onto itself repeats the first byte */
+	for(i = 0; i < 16; i ++) { a[i] = 'a' + i; }
+	ecx = 8; esi = a; edi = a + 1;
+	REP("rep movsb", 0);
+	nemu_assert(ecx == 0 && esi == a + 8 && edi == a + 9);
+	for(i = 0; i <= 8; i ++) { nemu_assert(a[i] == 'a'); }
+	nemu_assert(a[9] == 'a' + 9);
+
+	/* a fill and a copy over two page boundaries, with an element
+	 * crossing the first one */
+	ecx = (PAGE + 100) / 4; esi = 0; edi = a + PAGE - 6;
+	REP("rep stosl", 0x5a5a5a5a);
+	nemu_assert(ecx == 0 && edi == a + PAGE - 6 + (PAGE + 100) / 4 * 4);
+	for(i = PAGE - 6; i < 2 * PAGE + 94; i ++) { nemu_assert(a[i] == 0x5a); }
+	nemu_assert(a[2 * PAGE + 94] == 0);
+
+	ecx = 2 * PAGE + 10; esi = a + 3; edi = b + 5;
+	REP("rep movsb", 0);
+	nemu_assert(ecx == 0 && esi == a + 2 * PAGE + 13 && edi == b + 2 * PAGE + 15);
+	for(i = 0; i < 2 * PAGE + 10; i ++) { nemu_assert(b[i + 5] == a[i + 3]); }
+
+	/* repe cmps stops at the first difference, in the middle of a page */
+	for(i = 0; i < 3 * PAGE; i ++) { a[i] = b[i] = i % 7; }
+	b[PAGE + 1234] = 100;
+	ecx = 2 * PAGE; esi = a + 10; edi = b + 10;
+	REP("repe cmpsb", 0);
+	nemu_assert(ecx == 2 * PAGE - (PAGE + 1225) && esi == a + PAGE + 1235 && edi == b + PAGE + 1235 && zf == 0);
+
+	/* and runs to the end with ZF set when nothing differs */
+	b[PAGE + 1234] = a[PAGE + 1234];
+	ecx = (2 * PAGE) / 4; esi = a + 2; edi = b + 2;
+	REP("repe cmpsl", 0);
+	nemu_assert(ecx == 0 && esi == a + 2 * PAGE + 2 && edi == b + 2 * PAGE + 2 && zf == 1);
+
+	/* repne scas stops at the first match, in the middle of a page */
+	for(i = 0; i < 3 * PAGE; i ++) { a[i] = 'x'; }
+	a[PAGE + 2000] = 'y';
+	ecx = 2 * PAGE; esi = 0; edi = a + 100;
+	REP("repne scasb", 'y');
+	nemu_assert(ecx == 2 * PAGE - (PAGE + 1901) && edi == a + PAGE + 2001 && zf == 1);
+
+	/* and runs to the end with ZF clear when nothing matches */
+	ecx = PAGE; esi = 0; edi = a + 2 * PAGE;
+	REP("repne scasb", 'y');
+	nemu_assert(ecx == 0 && edi == a + 3 * PAGE && zf == 0);
+
+	return 0;
+}